@@ -0,0 +1,240 @@
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "BookCatalogue.h"
+#include "QuizConfig.h"
+
+static const quint32 INDEX_MAGIC = 0x515a4243; // "QZBC"
+static const quint32 INDEX_VERSION = 2;
+
+typedef QPair<QString, int> WordEntry;
+
+struct CatalogueEntry {
+    QString key;
+    QString title;
+    QString author;
+    QString path;
+
+    bool operator<(const CatalogueEntry &other) const
+    {
+        return key < other.key || (key == other.key && title < other.title);
+    }
+};
+
+static bool wordLessThan(const WordEntry &entry, const QString &word)
+{
+    return entry.first < word;
+}
+
+bool BookCatalogue::load(QString *error)
+{
+    QFileInfo source(BOOKS_LIST_PATH);
+    if (!source.exists()) {
+        if (error) *error = "Unable to open books list file.";
+        return false;
+    }
+
+    qint64 modified = source.lastModified().toMSecsSinceEpoch();
+    qint64 size = source.size();
+    if (modified == m_sourceModified && size == m_sourceSize) {
+        return true;
+    }
+
+    if (!readIndex(modified, size) && !rebuild(modified, size, error)) {
+        return false;
+    }
+    m_sourceModified = modified;
+    m_sourceSize = size;
+    buildWordIndex();
+    return true;
+}
+
+int BookCatalogue::indexOf(const QString &title) const
+{
+    // Titles are sorted by key, so narrow down to the entries sharing it
+    QString key = foldKey(title);
+    QStringList::const_iterator it = std::lower_bound(m_keys.constBegin(), m_keys.constEnd(), key);
+    for (int i = it - m_keys.constBegin(); i < m_keys.size() && m_keys.at(i) == key; ++i) {
+        if (m_titles.at(i) == title) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QVector<int> BookCatalogue::filter(const QString &text) const
+{
+    QVector<int> result;
+    QStringList words = foldKey(text).split(' ', QString::SkipEmptyParts);
+    if (words.isEmpty()) {
+        result.reserve(m_titles.size());
+        for (int i = 0; i < m_titles.size(); ++i) {
+            result.append(i);
+        }
+        return result;
+    }
+
+    // Look up the longest word, then check the rest against each candidate
+    QString probe = words.first();
+    for (const QString &word : words) {
+        if (word.size() > probe.size()) {
+            probe = word;
+        }
+    }
+
+    QVector<WordEntry>::const_iterator it = std::lower_bound(m_words.constBegin(), m_words.constEnd(), probe, wordLessThan);
+    for (; it != m_words.constEnd() && it->first.startsWith(probe); ++it) {
+        const QString &key = m_keys.at(it->second);
+        bool matches = true;
+        for (const QString &word : words) {
+            if (!key.startsWith(word) && !key.contains(' ' + word)) {
+                matches = false;
+                break;
+            }
+        }
+        if (matches) {
+            result.append(it->second);
+        }
+    }
+
+    // Keep alphabetical order and drop titles matched through several words
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+bool BookCatalogue::readIndex(qint64 sourceModified, qint64 sourceSize)
+{
+    QFile file(BOOKS_INDEX_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic, version;
+    qint64 modified, size;
+    qint32 count;
+    in >> magic >> version >> modified >> size >> count;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+            || modified != sourceModified || size != sourceSize || count < 0) {
+        return false;
+    }
+
+    QStringList titles, authors, paths;
+    titles.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+        QByteArray title, author, path;
+        in >> title >> author >> path;
+        titles.append(QString::fromUtf8(title));
+        authors.append(QString::fromUtf8(author));
+        paths.append(QString::fromUtf8(path));
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_titles = titles;
+    m_authors = authors;
+    m_paths = paths;
+    m_keys.clear();
+    m_keys.reserve(count);
+    for (const QString &title : m_titles) {
+        m_keys.append(foldKey(title));
+    }
+    return true;
+}
+
+bool BookCatalogue::rebuild(qint64 sourceModified, qint64 sourceSize, QString *error)
+{
+    QFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Unable to open books.json";
+        if (error) *error = "Unable to open books list file.";
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        qWarning() << "Invalid books JSON format!";
+        if (error) *error = "Invalid books list format.";
+        return false;
+    }
+
+    QVector<CatalogueEntry> entries;
+    for (const QJsonValue &val : doc.object()["books"].toArray()) {
+        CatalogueEntry entry;
+        if (val.isObject()) {
+            QJsonObject obj = val.toObject();
+            entry.title = obj["title"].toString();
+            entry.author = obj["author"].toString();
+            entry.path = obj["path"].toString();
+        } else {
+            entry.title = val.toString();
+        }
+        if (!entry.title.isEmpty()) {
+            entry.key = foldKey(entry.title);
+            entries.append(entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    m_titles.clear();
+    m_keys.clear();
+    m_authors.clear();
+    m_paths.clear();
+    for (const CatalogueEntry &entry : entries) {
+        m_keys.append(entry.key);
+        m_titles.append(entry.title);
+        m_authors.append(entry.author);
+        m_paths.append(entry.path);
+    }
+
+    writeIndex(sourceModified, sourceSize);
+    return true;
+}
+
+void BookCatalogue::writeIndex(qint64 sourceModified, qint64 sourceSize) const
+{
+    QSaveFile file(BOOKS_INDEX_PATH);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Unable to write" << BOOKS_INDEX_PATH;
+        return;
+    }
+
+    QDataStream out(&file);
+    out << INDEX_MAGIC << INDEX_VERSION << sourceModified << sourceSize << qint32(m_titles.size());
+    for (int i = 0; i < m_titles.size(); ++i) {
+        out << m_titles.at(i).toUtf8() << m_authors.at(i).toUtf8() << m_paths.at(i).toUtf8();
+    }
+    file.commit();
+}
+
+void BookCatalogue::buildWordIndex()
+{
+    m_words.clear();
+    for (int i = 0; i < m_keys.size(); ++i) {
+        for (const QString &word : m_keys.at(i).split(' ', QString::SkipEmptyParts)) {
+            m_words.append(qMakePair(word, i));
+        }
+    }
+    std::sort(m_words.begin(), m_words.end());
+}
+
+QString BookCatalogue::foldKey(const QString &text)
+{
+    // Case-insensitive, with punctuation treated as word breaks
+    QString key = text.toCaseFolded();
+    for (int i = 0; i < key.size(); ++i) {
+        if (!key.at(i).isLetterOrNumber()) {
+            key[i] = ' ';
+        }
+    }
+    return key.simplified();
+}
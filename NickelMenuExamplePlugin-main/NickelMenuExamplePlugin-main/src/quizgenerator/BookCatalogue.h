@@ -0,0 +1,49 @@
+#ifndef BOOK_CATALOGUE_H
+#define BOOK_CATALOGUE_H
+
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "QuizConfig.h"
+
+const QString BOOKS_INDEX_PATH = ONBOARD_ROOT + "/.adds/quiz/books.idx";
+
+// Sorted, prefix-searchable view of books.json, whose entries are either
+// plain titles or objects with a title, author and file path. The parsed list is kept
+// in a compact index file next to it and only rebuilt when books.json
+// changes, so opening the selection screen never re-parses the JSON.
+class BookCatalogue
+{
+    public:
+        bool load(QString *error = nullptr);
+
+        int count() const { return m_titles.size(); }
+        const QStringList& titles() const { return m_titles; }
+        QString title(int index) const { return m_titles.value(index); }
+        QString author(int index) const { return m_authors.value(index); }
+        QString path(int index) const { return m_paths.value(index); }
+        int indexOf(const QString &title) const;
+
+        // Indices of titles with a word starting with every word in text
+        QVector<int> filter(const QString &text) const;
+
+    private:
+        bool readIndex(qint64 sourceModified, qint64 sourceSize);
+        bool rebuild(qint64 sourceModified, qint64 sourceSize, QString *error);
+        void writeIndex(qint64 sourceModified, qint64 sourceSize) const;
+        void buildWordIndex();
+
+        static QString foldKey(const QString &text);
+
+        QStringList m_titles;  // Sorted by folded key
+        QStringList m_keys;
+        QStringList m_authors;
+        QStringList m_paths;  // Book file, when imported from the device library
+        QVector<QPair<QString, int> > m_words;  // (folded word, title index), sorted
+        qint64 m_sourceModified = -1;
+        qint64 m_sourceSize = -1;
+};
+
+#endif // BOOK_CATALOGUE_H
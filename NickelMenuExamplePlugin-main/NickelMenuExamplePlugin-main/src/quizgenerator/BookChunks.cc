@@ -0,0 +1,189 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QVector>
+
+#include "BookChunks.h"
+#include "EpubReader.h"
+
+static const quint32 CHUNKS_MAGIC = 0x515a4348; // "QZCH"
+static const quint32 CHUNKS_VERSION = 1;
+
+// A chapter can be large, but one runaway document must not exhaust memory
+static const int MAX_DOCUMENT_BYTES = 2 * 1024 * 1024;
+static const int CHUNK_CHARS = 1200;
+
+struct ChunksHeader {
+    qint64 sourceModified = -1;
+    qint64 sourceSize = -1;
+    qint32 count = 0;
+    qint64 tableOffset = 0;
+};
+
+static bool readHeader(QDataStream &in, ChunksHeader &header)
+{
+    quint32 magic, version;
+    in >> magic >> version >> header.sourceModified >> header.sourceSize >> header.count >> header.tableOffset;
+    return in.status() == QDataStream::Ok && magic == CHUNKS_MAGIC && version == CHUNKS_VERSION;
+}
+
+static bool isCurrent(const ChunksHeader &header, const QFileInfo &source)
+{
+    return header.sourceModified == source.lastModified().toMSecsSinceEpoch()
+        && header.sourceSize == source.size() && header.count > 0;
+}
+
+// The first heading of a document, or its <title>
+static QString chapterTitle(const QByteArray &html, int index)
+{
+    static const char* const openings[] = { "<h1", "<h2", "<h3", "<title" };
+    for (const char *opening : openings) {
+        int start = html.indexOf(opening);
+        if (start < 0) {
+            continue;
+        }
+        int end = html.indexOf("</", start);
+        QString title = EpubReader::stripMarkup(html.mid(start, end < 0 ? 200 : end - start)).simplified();
+        if (!title.isEmpty()) {
+            return title.left(80);
+        }
+    }
+    return QString("Part %1").arg(index + 1);
+}
+
+QString BookChunks::cachePath(const QString &bookPath)
+{
+    QByteArray hash = QCryptographicHash::hash(bookPath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return BOOK_CHUNKS_DIR + "/" + QString::fromLatin1(hash) + ".chunks";
+}
+
+bool BookChunks::isCached(const QString &bookPath)
+{
+    QFile file(cachePath(bookPath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    ChunksHeader header;
+    return readHeader(in, header) && isCurrent(header, QFileInfo(bookPath));
+}
+
+bool BookChunks::extract(const QString &bookPath, QString *error)
+{
+    EpubReader epub;
+    if (!epub.open(bookPath, error)) {
+        return false;
+    }
+
+    QString path = cachePath(bookPath);
+    QDir().mkpath(BOOK_CHUNKS_DIR);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = "Unable to write " + path;
+        return false;
+    }
+
+    // The count and table offset are filled in once everything is written
+    QFileInfo source(bookPath);
+    ChunksHeader header;
+    header.sourceModified = source.lastModified().toMSecsSinceEpoch();
+    header.sourceSize = source.size();
+    QDataStream out(&file);
+    out << CHUNKS_MAGIC << CHUNKS_VERSION << header.sourceModified << header.sourceSize
+        << header.count << header.tableOffset;
+
+    QVector<qint64> offsets;
+    const QStringList &spine = epub.spine();
+    for (int chapter = 0; chapter < spine.size(); ++chapter) {
+        QByteArray html = epub.read(spine.at(chapter), MAX_DOCUMENT_BYTES);
+        QByteArray title = chapterTitle(html, chapter).toUtf8();
+        QStringList paragraphs = EpubReader::stripMarkup(html).split('\n', QString::SkipEmptyParts);
+        html.clear();
+
+        // Whole paragraphs, grouped until a chunk is long enough
+        QString chunk;
+        for (int i = 0; i <= paragraphs.size(); ++i) {
+            bool last = i == paragraphs.size();
+            if (!last) {
+                QString paragraph = paragraphs.at(i).simplified();
+                if (paragraph.isEmpty()) {
+                    continue;
+                }
+                chunk += (chunk.isEmpty() ? "" : "\n") + paragraph;
+            }
+            if (chunk.size() >= CHUNK_CHARS || (last && !chunk.isEmpty())) {
+                offsets.append(file.pos());
+                out << qint32(chapter) << title << chunk.toUtf8();
+                chunk.clear();
+            }
+        }
+    }
+
+    header.count = offsets.size();
+    header.tableOffset = file.pos();
+    for (qint64 offset : offsets) {
+        out << offset;
+    }
+    file.seek(0);
+    out << CHUNKS_MAGIC << CHUNKS_VERSION << header.sourceModified << header.sourceSize
+        << header.count << header.tableOffset;
+
+    if (out.status() != QDataStream::Ok || header.count == 0 || !file.commit()) {
+        if (error) *error = header.count == 0 ? "The book has no text." : "Unable to write " + path;
+        return false;
+    }
+    return true;
+}
+
+QString BookChunks::excerpt(const QString &bookPath, int maxChars)
+{
+    QFile file(cachePath(bookPath));
+    if (maxChars <= 0 || !file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QDataStream in(&file);
+    ChunksHeader header;
+    if (!readHeader(in, header) || !isCurrent(header, QFileInfo(bookPath))) {
+        return QString();
+    }
+
+    // Skip roughly the first tenth, where the front matter lives
+    int first = header.count / 10;
+    int start = first + qrand() % qMax(1, header.count - first);
+    qint64 offset = 0;
+    if (!file.seek(header.tableOffset + start * qint64(sizeof(qint64)))) {
+        return QString();
+    }
+    in >> offset;
+    if (!file.seek(offset)) {
+        return QString();
+    }
+
+    QString text;
+    qint32 startChapter = -1;
+    for (int i = start; i < header.count; ++i) {
+        qint32 chapter;
+        QByteArray title, chunk;
+        in >> chapter >> title >> chunk;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        if (startChapter < 0) {
+            startChapter = chapter;
+            text = "[" + QString::fromUtf8(title) + "]";
+        } else if (chapter != startChapter || text.size() + chunk.size() > maxChars) {
+            break;
+        }
+        text += "\n" + QString::fromUtf8(chunk);
+        if (text.size() >= maxChars) {
+            break;
+        }
+    }
+    return text.left(maxChars);
+}
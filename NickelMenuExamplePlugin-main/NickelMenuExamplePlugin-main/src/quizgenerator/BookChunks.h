@@ -0,0 +1,28 @@
+#ifndef BOOK_CHUNKS_H
+#define BOOK_CHUNKS_H
+
+#include <QString>
+
+#include "QuizConfig.h"
+
+const QString BOOK_CHUNKS_DIR = ONBOARD_ROOT + "/.adds/quiz/chunks";
+
+// On-disk cache of a book's text split into chapter-tagged chunks of a
+// few paragraphs. Extraction streams the EPUB one content document at a
+// time, so memory stays bounded by the largest chapter. An offset table
+// lets an excerpt be read without loading the rest of the book.
+class BookChunks
+{
+    public:
+        static QString cachePath(const QString &bookPath);
+        static bool isCached(const QString &bookPath);
+
+        // Rebuilds the cache for a book; safe to run on a worker thread
+        static bool extract(const QString &bookPath, QString *error = nullptr);
+
+        // Consecutive chunks of one chapter from a random point past the
+        // front matter, prefixed with the chapter title
+        static QString excerpt(const QString &bookPath, int maxChars);
+};
+
+#endif // BOOK_CHUNKS_H
@@ -0,0 +1,81 @@
+#include <QDebug>
+#include <QThread>
+
+#include "BookChunks.h"
+#include "BookExtractor.h"
+
+namespace {
+
+class ExtractionThread : public QThread
+{
+    public:
+        ExtractionThread(const QString &bookPath, QObject *parent)
+            : QThread(parent), m_bookPath(bookPath) {}
+
+        // Read only once the thread has finished
+        bool ok() const { return m_ok; }
+
+    protected:
+        void run() override
+        {
+            QString error;
+            m_ok = BookChunks::extract(m_bookPath, &error);
+            if (!m_ok) {
+                qWarning() << "BookExtractor:" << m_bookPath << error;
+            }
+        }
+
+    private:
+        QString m_bookPath;
+        bool m_ok = false;
+};
+
+}
+
+BookExtractor::BookExtractor(QObject *parent)
+    : QObject(parent)
+{
+}
+
+BookExtractor::~BookExtractor()
+{
+    // The thread only touches its own file, so letting it finish is safe
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+void BookExtractor::extract(const QString &bookPath)
+{
+    if (m_thread) {
+        if (bookPath != m_current) {
+            m_queued = bookPath;
+        }
+        return;
+    }
+    start(bookPath);
+}
+
+void BookExtractor::start(const QString &bookPath)
+{
+    m_current = bookPath;
+    m_thread = new ExtractionThread(bookPath, this);
+    connect(m_thread, &QThread::finished, this, &BookExtractor::onThreadFinished);
+    m_thread->start(QThread::LowPriority);
+}
+
+void BookExtractor::onThreadFinished()
+{
+    bool ok = static_cast<ExtractionThread*>(m_thread)->ok();
+    m_thread->deleteLater();
+    m_thread = nullptr;
+    QString done = m_current;
+    m_current.clear();
+
+    if (!m_queued.isEmpty()) {
+        QString next = m_queued;
+        m_queued.clear();
+        start(next);
+    }
+    emit finished(done, ok);
+}
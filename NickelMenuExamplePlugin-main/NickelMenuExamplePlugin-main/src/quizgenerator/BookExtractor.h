@@ -0,0 +1,34 @@
+#ifndef BOOK_EXTRACTOR_H
+#define BOOK_EXTRACTOR_H
+
+#include <QObject>
+#include <QString>
+
+class QThread;
+
+// Runs BookChunks::extract on a worker thread, one book at a time, and
+// reports back on the thread that owns the extractor
+class BookExtractor : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit BookExtractor(QObject *parent = nullptr);
+        ~BookExtractor();
+
+        // A request made while busy replaces any earlier queued one
+        void extract(const QString &bookPath);
+
+    signals:
+        void finished(const QString &bookPath, bool ok);
+
+    private:
+        void start(const QString &bookPath);
+        void onThreadFinished();
+
+        QThread* m_thread = nullptr;
+        QString m_current;
+        QString m_queued;
+};
+
+#endif // BOOK_EXTRACTOR_H
@@ -0,0 +1,79 @@
+#include "BookCatalogue.h"
+#include "BookListModel.h"
+
+// Rows handed to the view per fetchMore() call
+static const int FETCH_BATCH_SIZE = 50;
+
+BookListModel::BookListModel(const BookCatalogue *catalogue, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_catalogue(catalogue)
+{
+}
+
+void BookListModel::setFilter(const QString &text)
+{
+    beginResetModel();
+    m_filter = text;
+    m_unfiltered = text.trimmed().isEmpty();
+    m_matches = m_unfiltered ? QVector<int>() : m_catalogue->filter(text);
+    m_fetched = qMin(FETCH_BATCH_SIZE, totalCount());
+    endResetModel();
+}
+
+void BookListModel::reload()
+{
+    setFilter(m_filter);
+}
+
+int BookListModel::totalCount() const
+{
+    return m_unfiltered ? m_catalogue->count() : m_matches.size();
+}
+
+void BookListModel::ensureFetched(int row)
+{
+    int target = qMin(row + 1, totalCount());
+    if (target <= m_fetched) {
+        return;
+    }
+
+    // Round up to whole batches so paging does not fetch row by row
+    target = qMin(totalCount(), ((target + FETCH_BATCH_SIZE - 1) / FETCH_BATCH_SIZE) * FETCH_BATCH_SIZE);
+    beginInsertRows(QModelIndex(), m_fetched, target - 1);
+    m_fetched = target;
+    endInsertRows();
+}
+
+QString BookListModel::titleAt(int row) const
+{
+    if (row < 0 || row >= m_fetched) {
+        return QString();
+    }
+    return m_catalogue->title(m_unfiltered ? row : m_matches.at(row));
+}
+
+int BookListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+QVariant BookListModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid()) {
+        return QVariant();
+    }
+    return titleAt(index.row());
+}
+
+bool BookListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < totalCount();
+}
+
+void BookListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    ensureFetched(m_fetched + FETCH_BATCH_SIZE - 1);
+}
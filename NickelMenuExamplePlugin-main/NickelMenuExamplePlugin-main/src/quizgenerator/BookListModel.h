@@ -0,0 +1,40 @@
+#ifndef BOOK_LIST_MODEL_H
+#define BOOK_LIST_MODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+
+class BookCatalogue;
+
+// Lazily populated list of catalogue titles. Rows are exposed to the view
+// a page at a time through fetchMore(), and titles are only looked up
+// when the view asks for a visible row.
+class BookListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    public:
+        explicit BookListModel(const BookCatalogue *catalogue, QObject *parent = nullptr);
+
+        void setFilter(const QString &text);
+        void reload();
+
+        int totalCount() const;
+        void ensureFetched(int row);
+        QString titleAt(int row) const;
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+        bool canFetchMore(const QModelIndex &parent) const override;
+        void fetchMore(const QModelIndex &parent) override;
+
+    private:
+        const BookCatalogue* m_catalogue;
+        QString m_filter;
+        bool m_unfiltered = true;  // Rows map 1:1 onto the catalogue
+        QVector<int> m_matches;
+        int m_fetched = 0;
+};
+
+#endif // BOOK_LIST_MODEL_H
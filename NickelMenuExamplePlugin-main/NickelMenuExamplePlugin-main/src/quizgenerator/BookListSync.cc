@@ -0,0 +1,234 @@
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QSettings>
+#include <QStringList>
+#include <QUrlQuery>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+#include "BookListSync.h"
+#include "QuizConfig.h"
+#include "QuizNetwork.h"
+
+// Identifies the books.json a sync state was recorded for, so a list
+// rewritten by the library import or updateBooks.sh is fetched in full
+static QString listStamp()
+{
+    QFileInfo info(BOOKS_LIST_PATH);
+    if (!info.exists()) {
+        return QString();
+    }
+    return QString::number(info.lastModified().toMSecsSinceEpoch()) + ":" + QString::number(info.size());
+}
+
+// Books are either plain titles or objects with a title
+static QString entryTitle(const QJsonValue &value)
+{
+    return value.isObject() ? value.toObject()["title"].toString() : value.toString();
+}
+
+BookListSync::BookListSync(QObject *parent)
+    : QObject(parent)
+{
+    m_deadline.setSingleShot(true);
+    connect(&m_deadline, &QTimer::timeout, this, [this]() {
+        if (m_reply) {
+            m_reply->abort();
+        }
+    });
+}
+
+QUrl BookListSync::endpoint()
+{
+    QString server = QuizConfig::load().value("SERVER_URL");
+    if (server.isEmpty()) {
+        return QUrl();
+    }
+    while (server.endsWith('/')) {
+        server.chop(1);
+    }
+    return QUrl(server + "/books");
+}
+
+void BookListSync::start(int timeoutSecs)
+{
+    if (m_reply) {
+        return;
+    }
+
+    QUrl url = endpoint();
+    QSettings state(BOOKS_SYNC_STATE_PATH, QSettings::IniFormat);
+    bool known = state.value("server").toString() == url.toString()
+        && !state.value("stamp").toString().isEmpty()
+        && state.value("stamp").toString() == listStamp();
+
+    // Ask only for what changed since the list we already have
+    QString revision = known ? state.value("revision").toString() : QString();
+    if (!revision.isEmpty()) {
+        QUrlQuery query(url);
+        query.addQueryItem("since", revision);
+        url.setQuery(query);
+    }
+
+    QNetworkRequest request(url);
+    request.setRawHeader("Accept", "application/json");
+    QString etag = known ? state.value("etag").toString() : QString();
+    if (!etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", etag.toLatin1());
+    }
+    QuizNetwork::prepare(request);
+
+    m_reply = QuizNetwork::manager()->get(request);
+    connect(m_reply, &QNetworkReply::finished, this, &BookListSync::onReplyFinished);
+    m_deadline.start(qMax(5, timeoutSecs) * 1000);
+}
+
+void BookListSync::onReplyFinished()
+{
+    m_deadline.stop();
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        emit finished(false, false, reply->error() == QNetworkReply::OperationCanceledError
+                      ? QString("The server did not answer in time.") : reply->errorString());
+        return;
+    }
+
+    // Nothing changed: the local list is not even read
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        emit finished(true, false, QString());
+        return;
+    }
+
+    QByteArray data = reply->readAll();
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    QJsonObject root = doc.object();
+    QString etag = QString::fromLatin1(reply->rawHeader("ETag"));
+    QString revision = root["revision"].toVariant().toString();
+    QString error;
+
+    if (!root.contains("books")) {
+        bool changed = false;
+        if (!doc.isObject() || !(root.contains("added") || root.contains("removed"))) {
+            emit finished(false, false, "Invalid response from server");
+        } else if (!applyDelta(root, &changed, &error)) {
+            emit finished(false, false, error);
+        } else {
+            saveState(etag, revision);
+            emit finished(true, changed, QString());
+        }
+        return;
+    }
+
+    // Leave the file, and so the catalogue index, alone if nothing changed
+    QFile current(BOOKS_LIST_PATH);
+    if (current.open(QIODevice::ReadOnly) && current.readAll() == data) {
+        current.close();
+        saveState(etag, revision);
+        emit finished(true, false, QString());
+        return;
+    }
+    current.close();
+
+    if (!writeList(data, &error)) {
+        emit finished(false, false, error);
+        return;
+    }
+    saveState(etag, revision);
+    emit finished(true, true, QString());
+}
+
+// Removes the titles in "removed" and adds or updates those in "added",
+// keeping the other entries and their order as they are
+bool BookListSync::applyDelta(const QJsonObject &delta, bool *changed, QString *error)
+{
+    QFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = "Unable to open books list file.";
+        return false;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    if (!root.contains("books")) {
+        *error = "Invalid books list format.";
+        return false;
+    }
+
+    QSet<QString> removed;
+    for (const QJsonValue &val : delta["removed"].toArray()) {
+        removed.insert(entryTitle(val));
+    }
+
+    QHash<QString, QJsonValue> added;
+    QStringList addedOrder;
+    for (const QJsonValue &val : delta["added"].toArray()) {
+        QString title = entryTitle(val);
+        if (title.isEmpty()) {
+            continue;
+        }
+        if (!added.contains(title)) {
+            addedOrder.append(title);
+        }
+        added.insert(title, val);
+        removed.remove(title);
+    }
+
+    QJsonArray books;
+    for (const QJsonValue &val : root["books"].toArray()) {
+        QString title = entryTitle(val);
+        if (removed.contains(title)) {
+            *changed = true;
+            continue;
+        }
+        if (added.contains(title)) {
+            // Already listed: take the server's entry in its place
+            QJsonValue updated = added.take(title);
+            *changed = *changed || updated != val;
+            books.append(updated);
+            continue;
+        }
+        books.append(val);
+    }
+    for (const QString &title : addedOrder) {
+        if (added.contains(title)) {
+            books.append(added.value(title));
+            *changed = true;
+        }
+    }
+
+    if (!*changed) {
+        return true;
+    }
+    root["books"] = books;
+    return writeList(QJsonDocument(root).toJson(QJsonDocument::Compact), error);
+}
+
+bool BookListSync::writeList(const QByteArray &data, QString *error)
+{
+    QSaveFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        *error = "Unable to write " + BOOKS_LIST_PATH;
+        return false;
+    }
+    return true;
+}
+
+// Records what the list on disk now matches, for the next request
+void BookListSync::saveState(const QString &etag, const QString &revision)
+{
+    QSettings state(BOOKS_SYNC_STATE_PATH, QSettings::IniFormat);
+    state.setValue("server", endpoint().toString());
+    state.setValue("etag", etag);
+    state.setValue("revision", revision);
+    state.setValue("stamp", listStamp());
+}
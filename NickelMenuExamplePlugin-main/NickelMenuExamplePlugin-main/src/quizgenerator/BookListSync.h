@@ -0,0 +1,49 @@
+#ifndef BOOK_LIST_SYNC_H
+#define BOOK_LIST_SYNC_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+#include "QuizConfig.h"
+
+const QString BOOKS_SYNC_STATE_PATH = ONBOARD_ROOT + "/.adds/quiz/books.sync";
+
+class QByteArray;
+class QJsonObject;
+class QNetworkReply;
+
+// Fetches books.json from $SERVER_URL/books through the shared network
+// manager, replacing a curl run for each import. Once a list has been
+// fetched, later requests send its ETag and revision, so the server can
+// answer 304 or with only the titles added and removed since then; a
+// delta is applied to the local list. A full reply is checked to be a
+// JSON book list before it replaces the local file.
+class BookListSync : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit BookListSync(QObject *parent = nullptr);
+
+        // The books endpoint from .env, invalid when SERVER_URL is unset
+        static QUrl endpoint();
+
+        void start(int timeoutSecs);
+
+    signals:
+        // changed is false when the list on disk was already up to date
+        void finished(bool ok, bool changed, const QString &error);
+
+    private:
+        void onReplyFinished();
+        bool applyDelta(const QJsonObject &delta, bool *changed, QString *error);
+        bool writeList(const QByteArray &data, QString *error);
+        void saveState(const QString &etag, const QString &revision);
+
+        QNetworkReply* m_reply = nullptr;
+        QTimer m_deadline;
+};
+
+#endif // BOOK_LIST_SYNC_H
@@ -0,0 +1,261 @@
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "ClozeGenerator.h"
+#include "EpubReader.h"
+
+// Limits that keep generation well under a second on the device
+static const int MAX_DOCUMENTS = 12;
+static const int MAX_DOCUMENT_BYTES = 64 * 1024;
+static const int MAX_TEXT_CHARS = 400 * 1024;
+
+static const int MIN_SENTENCE = 50;
+static const int MAX_SENTENCE = 220;
+static const char BLANK[] = "_____";
+
+static const char* const STOP_WORDS[] = {
+    "about", "above", "after", "again", "against", "because", "before", "being", "below", "between",
+    "could", "during", "every", "further", "himself", "herself", "itself", "myself", "nothing",
+    "other", "ourselves", "should", "something", "themselves", "there", "these", "those", "through",
+    "under", "until", "where", "which", "while", "would", "yourself", "another", "anything",
+    "everything", "someone", "somebody", "without", "whatever", "whenever", "however", "perhaps",
+    "suddenly", "already", "although", "actually", "probably", "certainly", "chapter", "contents",
+    "copyright", "thought", "looked", "seemed", "started", "turned", "walked", "little", "thing",
+    "things", "really", "always", "around", "toward", "towards", "across", "behind", "beside",
+    "beyond", "within", "The", "And", "But", "Then", "When", "What", "This", "That", "There",
+    "They", "She", "His", "Her", "Its", "You", "Your", "Our", "Their", "Mr", "Mrs", "Ms", "Dr",
+};
+
+// Seeded once per process; std::random_shuffle is gone from C++17
+static std::mt19937 &randomEngine()
+{
+    static std::mt19937 engine{std::random_device()()};
+    return engine;
+}
+
+struct Term {
+    int count = 0;
+    int capitalized = 0;  // Occurrences capitalized in mid-sentence
+    bool proper = false;
+    double score = 0;
+};
+
+struct Candidate {
+    int sentence;
+    QString term;
+};
+
+static bool isWordChar(QChar c)
+{
+    return c.isLetter() || c == '\'' || c == '-';
+}
+
+// Words of a sentence with their positions, trimmed of edge punctuation
+static QVector<QPair<int, QString> > words(const QString &sentence)
+{
+    QVector<QPair<int, QString> > result;
+    int n = sentence.size();
+    int i = 0;
+    while (i < n) {
+        while (i < n && !sentence.at(i).isLetter()) {
+            ++i;
+        }
+        int start = i;
+        while (i < n && isWordChar(sentence.at(i))) {
+            ++i;
+        }
+        int end = i;
+        while (end > start && !sentence.at(end - 1).isLetter()) {
+            --end;
+        }
+        if (end > start) {
+            result.append(qMakePair(start, sentence.mid(start, end - start)));
+        }
+    }
+    return result;
+}
+
+static QStringList sentences(const QString &text)
+{
+    QStringList result;
+    int start = 0;
+    int n = text.size();
+    for (int i = 0; i < n; ++i) {
+        QChar c = text.at(i);
+        bool end = c == '\n'
+            || ((c == '.' || c == '!' || c == '?') && (i + 1 == n || text.at(i + 1).isSpace()));
+        if (end) {
+            QString sentence = text.mid(start, i - start + 1).simplified();
+            if (sentence.size() >= MIN_SENTENCE && sentence.size() <= MAX_SENTENCE) {
+                result.append(sentence);
+            }
+            start = i + 1;
+        }
+    }
+    return result;
+}
+
+QList<QuizItem> ClozeGenerator::generate(const QString &bookPath, int count, QString *error)
+{
+    EpubReader epub;
+    if (!epub.open(bookPath, error)) {
+        return QList<QuizItem>();
+    }
+
+    // Sample documents spread over the book, skipping the front matter
+    const QStringList &spine = epub.spine();
+    int first = spine.size() > 4 ? spine.size() / 10 : 0;
+    int available = spine.size() - first;
+    int step = qMax(1, available / MAX_DOCUMENTS);
+
+    QString text;
+    for (int i = first; i < spine.size() && text.size() < MAX_TEXT_CHARS; i += step) {
+        text += epub.text(spine.at(i), MAX_DOCUMENT_BYTES);
+        text += '\n';
+    }
+
+    QList<QuizItem> items = generateFromText(text, count);
+    if (items.isEmpty() && error) {
+        *error = "Not enough text in this book to build a quiz.";
+    }
+    return items;
+}
+
+QList<QuizItem> ClozeGenerator::generateFromText(const QString &text, int count)
+{
+    QList<QuizItem> items;
+    QStringList all = sentences(text);
+    if (all.isEmpty() || count <= 0) {
+        return items;
+    }
+
+    QSet<QString> stopWords;
+    for (const char *word : STOP_WORDS) {
+        stopWords.insert(QString::fromLatin1(word).toLower());
+    }
+
+    // Count every word, noting how often it is capitalized mid-sentence
+    QHash<QString, Term> terms;
+    QVector<QVector<QPair<int, QString> > > sentenceWords;
+    sentenceWords.reserve(all.size());
+    for (const QString &sentence : all) {
+        sentenceWords.append(words(sentence));
+        const QVector<QPair<int, QString> > &list = sentenceWords.last();
+        for (int i = 0; i < list.size(); ++i) {
+            const QString &word = list.at(i).second;
+            if (word.size() < 4) {
+                continue;
+            }
+            Term &term = terms[word.toLower()];
+            term.count++;
+            if (i > 0 && word.at(0).isUpper()) {
+                term.capitalized++;
+            }
+        }
+    }
+
+    // Names that are nearly always capitalized and longer recurring words
+    QHash<QString, Term>::iterator it = terms.begin();
+    while (it != terms.end()) {
+        Term &term = it.value();
+        term.proper = term.count >= 2 && term.capitalized * 5 >= term.count * 4;
+        bool content = it.key().size() >= 7 && term.count >= 2 && term.capitalized == 0;
+        if (stopWords.contains(it.key()) || (!term.proper && !content)) {
+            it = terms.erase(it);
+            continue;
+        }
+        term.score = std::log(1.0 + term.count) * (term.proper ? 2.0 : 1.0) * std::sqrt(double(it.key().size()));
+        ++it;
+    }
+
+    // Display forms of the key terms, split by kind for picking distractors
+    QHash<QString, QString> forms;
+    QStringList properTerms, contentTerms;
+
+    // One candidate per sentence: its best key term, not the opening word
+    QVector<Candidate> candidates;
+    for (int s = 0; s < all.size(); ++s) {
+        const QVector<QPair<int, QString> > &list = sentenceWords.at(s);
+        QString best;
+        double bestScore = 0;
+        for (int i = 1; i < list.size(); ++i) {
+            QString key = list.at(i).second.toLower();
+            QHash<QString, Term>::const_iterator term = terms.constFind(key);
+            if (term == terms.constEnd()) {
+                continue;
+            }
+            if (!forms.contains(key)) {
+                forms.insert(key, term->proper ? list.at(i).second : key);
+                (term->proper ? properTerms : contentTerms).append(key);
+            }
+            if (term->score > bestScore) {
+                best = key;
+                bestScore = term->score;
+            }
+        }
+        if (!best.isEmpty()) {
+            Candidate candidate = { s, best };
+            candidates.append(candidate);
+        }
+    }
+
+    // Spread the questions over the sample, each with a different answer
+    std::shuffle(candidates.begin(), candidates.end(), randomEngine());
+    QSet<QString> used;
+    for (const Candidate &candidate : candidates) {
+        if (items.size() >= count) {
+            break;
+        }
+        if (used.contains(candidate.term)) {
+            continue;
+        }
+
+        bool proper = terms.value(candidate.term).proper;
+        QStringList pool = proper ? properTerms : contentTerms;
+        const QString &sentence = all.at(candidate.sentence);
+
+        // Distractors of similar length that do not appear in the sentence
+        QString lowerSentence = sentence.toLower();
+        std::shuffle(pool.begin(), pool.end(), randomEngine());
+        std::stable_sort(pool.begin(), pool.end(), [&](const QString &a, const QString &b) {
+            return qAbs(a.size() - candidate.term.size()) < qAbs(b.size() - candidate.term.size());
+        });
+        QStringList options;
+        for (const QString &key : pool) {
+            if (options.size() >= 3) {
+                break;
+            }
+            if (key != candidate.term && !lowerSentence.contains(key)) {
+                options.append(forms.value(key));
+            }
+        }
+        if (options.size() < 3) {
+            continue;
+        }
+
+        // Blank every occurrence of the term as a whole word
+        QString blanked = sentence;
+        const QVector<QPair<int, QString> > &list = sentenceWords.at(candidate.sentence);
+        for (int i = list.size() - 1; i >= 0; --i) {
+            if (list.at(i).second.toLower() == candidate.term) {
+                blanked.replace(list.at(i).first, list.at(i).second.size(), BLANK);
+            }
+        }
+
+        QuizItem item;
+        item.correctAnswer = forms.value(candidate.term);
+        std::uniform_int_distribution<int> position(0, options.size());
+        options.insert(position(randomEngine()), item.correctAnswer);
+        item.options = options;
+        item.question = "Fill in the blank:\n" + blanked;
+        item.explanation = "From the book: \"" + sentence + "\"";
+        items.append(item);
+        used.insert(candidate.term);
+    }
+    return items;
+}
@@ -0,0 +1,22 @@
+#ifndef CLOZE_GENERATOR_H
+#define CLOZE_GENERATOR_H
+
+#include <QList>
+#include <QString>
+
+#include "QuizItem.h"
+
+// Builds fill-in-the-blank questions from a book's own text, for when no
+// network is available. Key terms are the book's recurring names and
+// longer content words. Each question blanks one in a sentence, and the
+// distractors are other key terms of the same kind.
+class ClozeGenerator
+{
+    public:
+        // Samples the EPUB at bookPath and returns up to count questions
+        static QList<QuizItem> generate(const QString &bookPath, int count, QString *error = nullptr);
+
+        static QList<QuizItem> generateFromText(const QString &text, int count);
+};
+
+#endif // CLOZE_GENERATOR_H
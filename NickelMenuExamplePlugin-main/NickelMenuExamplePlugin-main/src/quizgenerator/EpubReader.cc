@@ -0,0 +1,284 @@
+#include <QDebug>
+#include <QUrl>
+#include <QXmlStreamReader>
+#include <QtEndian>
+#include <cstring>
+#include <zlib.h>
+
+#include "EpubReader.h"
+
+static const quint32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const quint32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const quint32 END_OF_DIRECTORY_SIGNATURE = 0x06054b50;
+
+static quint16 read16(const char *data)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(data));
+}
+
+static quint32 read32(const char *data)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data));
+}
+
+// Resolves an OPF href against the directory of the OPF file
+static QString resolvePath(const QString &base, const QString &href)
+{
+    QString path = QUrl::fromPercentEncoding(href.section('#', 0, 0).toUtf8());
+    QStringList parts = (base.isEmpty() ? path : base + "/" + path).split('/');
+    QStringList resolved;
+    for (const QString &part : parts) {
+        if (part == "..") {
+            if (!resolved.isEmpty()) {
+                resolved.removeLast();
+            }
+        } else if (!part.isEmpty() && part != ".") {
+            resolved.append(part);
+        }
+    }
+    return resolved.join("/");
+}
+
+bool EpubReader::open(const QString &path, QString *error)
+{
+    m_file.close();
+    m_file.setFileName(path);
+    m_entries.clear();
+    m_spine.clear();
+
+    if (!m_file.open(QIODevice::ReadOnly) || !readCentralDirectory()) {
+        if (error) *error = "Unable to read the book file.";
+        return false;
+    }
+
+    // Kobo store books are encrypted and cannot be read as plain text
+    if (m_entries.contains("META-INF/encryption.xml") || m_entries.contains("rights.xml")) {
+        if (error) *error = "This book is protected and cannot be read offline.";
+        return false;
+    }
+
+    return readSpine(error);
+}
+
+bool EpubReader::readCentralDirectory()
+{
+    // The end-of-directory record sits in the last 64 KiB, after the comment
+    qint64 size = m_file.size();
+    qint64 tailSize = qMin<qint64>(size, 65535 + 22);
+    if (tailSize < 22 || !m_file.seek(size - tailSize)) {
+        return false;
+    }
+    QByteArray tail = m_file.read(tailSize);
+
+    int eocd = -1;
+    for (int i = tail.size() - 22; i >= 0; --i) {
+        if (read32(tail.constData() + i) == END_OF_DIRECTORY_SIGNATURE) {
+            eocd = i;
+            break;
+        }
+    }
+    if (eocd < 0) {
+        return false;
+    }
+
+    const char *record = tail.constData() + eocd;
+    quint16 count = read16(record + 10);
+    quint32 directorySize = read32(record + 12);
+    quint32 directoryOffset = read32(record + 16);
+    if (!m_file.seek(directoryOffset)) {
+        return false;
+    }
+    QByteArray directory = m_file.read(directorySize);
+
+    int pos = 0;
+    for (int i = 0; i < count && pos + 46 <= directory.size(); ++i) {
+        const char *header = directory.constData() + pos;
+        if (read32(header) != CENTRAL_HEADER_SIGNATURE) {
+            return false;
+        }
+        quint16 nameLength = read16(header + 28);
+        quint16 extraLength = read16(header + 30);
+        quint16 commentLength = read16(header + 32);
+        if (pos + 46 + nameLength > directory.size()) {
+            return false;
+        }
+
+        Entry entry;
+        entry.method = read16(header + 10);
+        entry.compressedSize = read32(header + 20);
+        entry.size = read32(header + 24);
+        entry.localOffset = read32(header + 42);
+        m_entries.insert(QString::fromUtf8(header + 46, nameLength), entry);
+
+        pos += 46 + nameLength + extraLength + commentLength;
+    }
+    return !m_entries.isEmpty();
+}
+
+QByteArray EpubReader::read(const QString &name, int maxBytes)
+{
+    QHash<QString, Entry>::const_iterator it = m_entries.constFind(name);
+    if (it == m_entries.constEnd() || !m_file.seek(it->localOffset)) {
+        return QByteArray();
+    }
+
+    QByteArray header = m_file.read(30);
+    if (header.size() < 30 || read32(header.constData()) != LOCAL_HEADER_SIGNATURE) {
+        return QByteArray();
+    }
+    qint64 dataOffset = it->localOffset + 30 + read16(header.constData() + 26) + read16(header.constData() + 28);
+    if (!m_file.seek(dataOffset)) {
+        return QByteArray();
+    }
+
+    if (it->method == 0) {
+        return m_file.read(qMin<qint64>(it->size, maxBytes));
+    }
+    if (it->method != 8) {
+        return QByteArray();
+    }
+
+    // Raw deflate stream, inflated in chunks until the limit is reached
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return QByteArray();
+    }
+
+    QByteArray output;
+    output.resize(int(qMin<qint64>(it->size ? it->size : maxBytes, maxBytes)));
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = output.size();
+
+    qint64 remaining = it->compressedSize;
+    char input[16384];
+    int status = Z_OK;
+    while (status == Z_OK && stream.avail_out > 0 && remaining > 0) {
+        qint64 chunk = m_file.read(input, qMin<qint64>(sizeof(input), remaining));
+        if (chunk <= 0) {
+            break;
+        }
+        remaining -= chunk;
+        stream.next_in = reinterpret_cast<Bytef*>(input);
+        stream.avail_in = uInt(chunk);
+        while (stream.avail_in > 0 && stream.avail_out > 0 && status == Z_OK) {
+            status = inflate(&stream, Z_NO_FLUSH);
+        }
+    }
+
+    output.resize(int(stream.total_out));
+    inflateEnd(&stream);
+    if (status != Z_OK && status != Z_STREAM_END) {
+        return QByteArray();
+    }
+    return output;
+}
+
+bool EpubReader::readSpine(QString *error)
+{
+    QString opfPath;
+    QXmlStreamReader container(read("META-INF/container.xml"));
+    while (!container.atEnd() && opfPath.isEmpty()) {
+        if (container.readNext() == QXmlStreamReader::StartElement && container.name() == QLatin1String("rootfile")) {
+            opfPath = container.attributes().value("full-path").toString();
+        }
+    }
+    if (opfPath.isEmpty()) {
+        if (error) *error = "The book has no readable contents.";
+        return false;
+    }
+
+    QString base = opfPath.section('/', 0, -2);
+    QHash<QString, QString> manifest;
+    QStringList order;
+    QXmlStreamReader opf(read(opfPath));
+    while (!opf.atEnd()) {
+        if (opf.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (opf.name() == QLatin1String("item")) {
+            manifest.insert(opf.attributes().value("id").toString(),
+                            resolvePath(base, opf.attributes().value("href").toString()));
+        } else if (opf.name() == QLatin1String("itemref")) {
+            order.append(opf.attributes().value("idref").toString());
+        }
+    }
+
+    for (const QString &id : order) {
+        QString document = manifest.value(id);
+        if (m_entries.contains(document)) {
+            m_spine.append(document);
+        }
+    }
+    if (m_spine.isEmpty()) {
+        if (error) *error = "The book has no readable contents.";
+        return false;
+    }
+    return true;
+}
+
+QString EpubReader::text(const QString &document, int maxBytes)
+{
+    return stripMarkup(read(document, maxBytes));
+}
+
+// A forgiving scan rather than an XML parse: content documents often use
+// HTML entities or are cut off at the size limit
+QString EpubReader::stripMarkup(const QByteArray &html)
+{
+    QString source = QString::fromUtf8(html);
+    QString out;
+    out.reserve(source.size());
+
+    int bodyStart = source.indexOf("<body", 0, Qt::CaseInsensitive);
+    int i = bodyStart >= 0 ? bodyStart : 0;
+    int n = source.size();
+    while (i < n) {
+        QChar c = source.at(i);
+        if (c == '<') {
+            int end = source.indexOf('>', i);
+            if (end < 0) {
+                break;
+            }
+            QString tag = source.mid(i + 1, qMin(end - i - 1, 10)).toLower();
+            if (tag.startsWith("script") || tag.startsWith("style")) {
+                int close = source.indexOf(tag.startsWith("script") ? "</script" : "</style", end, Qt::CaseInsensitive);
+                end = close < 0 ? n - 1 : source.indexOf('>', close);
+                if (end < 0) {
+                    break;
+                }
+            }
+            // Block boundaries end a sentence-like run of text
+            if (tag.startsWith("/p") || tag.startsWith("br") || tag.startsWith("/div") || tag.startsWith("/h")
+                    || tag.startsWith("/li") || tag.startsWith("/td") || tag.startsWith("/blockquote")) {
+                out.append('\n');
+            } else {
+                out.append(' ');
+            }
+            i = end + 1;
+        } else if (c == '&') {
+            int end = source.indexOf(';', i);
+            if (end < 0 || end - i > 10) {
+                out.append(c);
+                ++i;
+                continue;
+            }
+            QString entity = source.mid(i + 1, end - i - 1);
+            if (entity == "amp") out.append('&');
+            else if (entity == "lt") out.append('<');
+            else if (entity == "gt") out.append('>');
+            else if (entity == "quot") out.append('"');
+            else if (entity == "apos" || entity == "rsquo" || entity == "lsquo") out.append('\'');
+            else if (entity == "ldquo" || entity == "rdquo") out.append('"');
+            else if (entity == "mdash" || entity == "ndash") out.append('-');
+            else if (entity.startsWith("#x")) out.append(QChar(entity.mid(2).toUInt(nullptr, 16)));
+            else if (entity.startsWith("#")) out.append(QChar(entity.mid(1).toUInt()));
+            else out.append(' ');
+            i = end + 1;
+        } else {
+            out.append(c);
+            ++i;
+        }
+    }
+    return out;
+}
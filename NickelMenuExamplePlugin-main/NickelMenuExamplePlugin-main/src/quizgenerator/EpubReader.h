@@ -0,0 +1,45 @@
+#ifndef EPUB_READER_H
+#define EPUB_READER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// Reads the text of an EPUB (or kepub) without unpacking it. The zip
+// central directory is parsed directly and entries are inflated with zlib,
+// stopping at a size limit, so sampling a large book stays cheap.
+class EpubReader
+{
+    public:
+        bool open(const QString &path, QString *error = nullptr);
+
+        // Content documents in reading order
+        const QStringList& spine() const { return m_spine; }
+
+        // Plain text of a content document, from at most maxBytes of markup
+        QString text(const QString &document, int maxBytes);
+
+        // Entry contents, cut off after maxBytes
+        QByteArray read(const QString &name, int maxBytes = 1 << 20);
+
+        static QString stripMarkup(const QByteArray &html);
+
+    private:
+        struct Entry {
+            quint16 method;
+            quint32 compressedSize;
+            quint32 size;
+            quint32 localOffset;
+        };
+
+        bool readCentralDirectory();
+        bool readSpine(QString *error);
+
+        QFile m_file;
+        QHash<QString, Entry> m_entries;
+        QStringList m_spine;
+};
+
+#endif // EPUB_READER_H
@@ -0,0 +1,68 @@
+#include <QThread>
+
+#include "LibraryImportJob.h"
+#include "LibraryImporter.h"
+
+namespace {
+
+class ImportThread : public QThread
+{
+    public:
+        explicit ImportThread(QObject *parent)
+            : QThread(parent) {}
+
+        // Read only once the thread has finished
+        bool ok() const { return m_ok; }
+        bool changed() const { return m_changed; }
+        QString error() const { return m_error; }
+
+    protected:
+        void run() override
+        {
+            LibraryImporter importer;
+            m_ok = importer.importBooks(&m_error);
+            m_changed = importer.changed();
+        }
+
+    private:
+        bool m_ok = false;
+        bool m_changed = false;
+        QString m_error;
+};
+
+}
+
+LibraryImportJob::LibraryImportJob(QObject *parent)
+    : QObject(parent)
+{
+}
+
+LibraryImportJob::~LibraryImportJob()
+{
+    // The import writes books.json through QSaveFile, so it must finish
+    if (m_thread) {
+        m_thread->wait();
+    }
+}
+
+void LibraryImportJob::start()
+{
+    if (m_thread) {
+        return;
+    }
+    m_thread = new ImportThread(this);
+    connect(m_thread, &QThread::finished, this, &LibraryImportJob::onThreadFinished);
+    m_thread->start(QThread::LowPriority);
+}
+
+void LibraryImportJob::onThreadFinished()
+{
+    ImportThread *thread = static_cast<ImportThread*>(m_thread);
+    bool ok = thread->ok();
+    bool changed = thread->changed();
+    QString error = thread->error();
+    m_thread->deleteLater();
+    m_thread = nullptr;
+
+    emit finished(ok, changed, error);
+}
@@ -0,0 +1,31 @@
+#ifndef LIBRARY_IMPORT_JOB_H
+#define LIBRARY_IMPORT_JOB_H
+
+#include <QObject>
+#include <QString>
+
+class QThread;
+
+// Runs LibraryImporter on a worker thread, so reading Nickel's database
+// never blocks the dialog, and reports back on the thread that owns the job
+class LibraryImportJob : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit LibraryImportJob(QObject *parent = nullptr);
+        ~LibraryImportJob();
+
+        // A no-op while an import is running; its result covers both
+        void start();
+
+    signals:
+        void finished(bool ok, bool changed, const QString &error);
+
+    private:
+        void onThreadFinished();
+
+        QThread* m_thread = nullptr;
+};
+
+#endif // LIBRARY_IMPORT_JOB_H
@@ -0,0 +1,240 @@
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QSettings>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <algorithm>
+
+#include "LibraryImporter.h"
+#include "QuizConfig.h"
+
+static const char CONNECTION_NAME[] = "quizgenerator-library";
+
+struct LibraryBook {
+    QString title;
+    QString author;
+    QString path;
+    QString lastRead;
+};
+
+// Sideloaded books are file:// URLs, store books live under .kobo/kepub
+static QString bookPath(const QString &contentId)
+{
+    if (contentId.startsWith("file://")) {
+        return contentId.mid(7);
+    }
+    return ONBOARD_ROOT + "/.kobo/kepub/" + contentId;
+}
+
+// Existing entries from a previous library import, keyed by content ID
+static bool readBooks(QMap<QString, LibraryBook> &books)
+{
+    QFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    for (const QJsonValue &val : doc.object()["books"].toArray()) {
+        QJsonObject obj = val.toObject();
+        QString id = obj["id"].toString();
+        if (id.isEmpty()) {
+            return false;  // Written by the server import
+        }
+        LibraryBook book;
+        book.title = obj["title"].toString();
+        book.author = obj["author"].toString();
+        book.path = obj["path"].toString();
+        book.lastRead = obj["last_read"].toString();
+        books.insert(id, book);
+    }
+    return true;
+}
+
+// Row count and highest rowid of the downloaded books, one aggregate row
+// instead of every ID; empty when the query fails
+static QString contentShape(QSqlDatabase &db, const QString &where)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT COUNT(*), MAX(rowid) FROM content " + where) || !query.next()) {
+        return QString();
+    }
+    return query.value(0).toString() + ":" + query.value(1).toString();
+}
+
+// Identifies the set of downloaded books
+static QString idsHash(QStringList ids)
+{
+    std::sort(ids.begin(), ids.end());
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &id : ids) {
+        hash.addData(id.toUtf8());
+        hash.addData("\n", 1);
+    }
+    return QString::number(ids.size()) + ":" + QString::fromLatin1(hash.result().toHex());
+}
+
+// Empty when the query fails
+static QString contentIdsHash(QSqlDatabase &db, const QString &where)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT ContentID FROM content " + where)) {
+        return QString();
+    }
+
+    QStringList ids;
+    while (query.next()) {
+        ids.append(query.value(0).toString());
+    }
+    return idsHash(ids);
+}
+
+static bool writeBooks(const QMap<QString, LibraryBook> &books)
+{
+    QJsonArray array;
+    for (QMap<QString, LibraryBook>::const_iterator it = books.constBegin(); it != books.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["id"] = it.key();
+        obj["title"] = it->title;
+        obj["author"] = it->author;
+        obj["path"] = it->path;
+        obj["last_read"] = it->lastRead;
+        array.append(obj);
+    }
+
+    QJsonObject root;
+    root["books"] = array;
+
+    QSaveFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+LibraryImporter::LibraryImporter(const QString &databasePath)
+    : m_databasePath(databasePath)
+{
+}
+
+bool LibraryImporter::importBooks(QString *error)
+{
+    m_changed = false;
+
+    QFileInfo database(m_databasePath);
+    if (!database.exists()) {
+        if (error) *error = "Kobo library database not found.";
+        return false;
+    }
+
+    // Nickel writes through the WAL, so either file changing means new data
+    QFileInfo wal(m_databasePath + "-wal");
+    qint64 stamp = database.lastModified().toMSecsSinceEpoch();
+    if (wal.exists()) {
+        stamp = qMax(stamp, wal.lastModified().toMSecsSinceEpoch());
+    }
+
+    QSettings state(LIBRARY_STATE_PATH, QSettings::IniFormat);
+    if (state.value("stamp").toLongLong() == stamp && QFile::exists(BOOKS_LIST_PATH)) {
+        return true;
+    }
+
+    QMap<QString, LibraryBook> books;
+    QString watermark = state.value("watermark").toString();
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+        db.setDatabaseName(m_databasePath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=2000");
+
+        if (db.open()) {
+            const QString where = "WHERE ContentType = 6 AND IsDownloaded = 'true'";
+
+            // Same set of books: only fetch what was read or synced since
+            // last time. A different count or highest rowid means books
+            // were added or removed. The same ones can still hide a book
+            // swapped for another, since SQLite reuses the highest rowid
+            // once it is deleted, so the IDs themselves are then compared.
+            QString shape = contentShape(db, where);
+            QString ids;
+            bool incremental = !shape.isEmpty() && shape == state.value("shape").toString()
+                && !watermark.isEmpty();
+            if (incremental) {
+                ids = contentIdsHash(db, where);
+                incremental = !ids.isEmpty() && ids == state.value("ids").toString() && readBooks(books);
+            }
+            if (!incremental) {
+                books.clear();
+            }
+            m_changed = !incremental;
+
+            QSqlQuery query(db);
+            QString sql = "SELECT ContentID, Title, Attribution, DateLastRead, ___SyncTime FROM content " + where;
+            if (incremental) {
+                sql += " AND (DateLastRead > ? OR ___SyncTime > ?)";
+            }
+            query.setForwardOnly(true);
+            query.prepare(sql);
+            if (incremental) {
+                query.addBindValue(watermark);
+                query.addBindValue(watermark);
+            }
+
+            if (query.exec()) {
+                // A full reload reads every ID anyway
+                QStringList allIds;
+                while (query.next()) {
+                    QString id = query.value(0).toString();
+                    if (!incremental) {
+                        allIds.append(id);
+                    }
+                    LibraryBook book;
+                    book.title = query.value(1).toString();
+                    book.author = query.value(2).toString();
+                    book.path = bookPath(id);
+                    book.lastRead = query.value(3).toString();
+                    if (book.title.isEmpty()) {
+                        continue;
+                    }
+                    books.insert(id, book);
+
+                    watermark = qMax(watermark, qMax(book.lastRead, query.value(4).toString()));
+                    m_changed = true;
+                }
+                state.setValue("shape", shape);
+                state.setValue("ids", incremental ? ids : idsHash(allIds));
+                ok = true;
+            } else {
+                qWarning() << "LibraryImporter: query failed:" << query.lastError().text();
+            }
+        } else {
+            qWarning() << "LibraryImporter: unable to open database:" << db.lastError().text();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+
+    if (!ok) {
+        if (error) *error = "Unable to read the Kobo library database.";
+        return false;
+    }
+
+    if ((m_changed || !QFile::exists(BOOKS_LIST_PATH)) && !writeBooks(books)) {
+        if (error) *error = "Unable to write books list file.";
+        return false;
+    }
+
+    state.setValue("stamp", stamp);
+    state.setValue("watermark", watermark);
+    return true;
+}
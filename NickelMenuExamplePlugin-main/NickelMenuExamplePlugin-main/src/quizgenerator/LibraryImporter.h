@@ -0,0 +1,28 @@
+#ifndef LIBRARY_IMPORTER_H
+#define LIBRARY_IMPORTER_H
+
+#include <QString>
+
+#include "QuizConfig.h"
+
+const QString KOBO_DATABASE_PATH = ONBOARD_ROOT + "/.kobo/KoboReader.sqlite";
+const QString LIBRARY_STATE_PATH = ONBOARD_ROOT + "/.adds/quiz/library.state";
+
+// Builds books.json from Nickel's own library database. The database is
+// opened read-only and skipped entirely while its mtime is unchanged;
+// otherwise only rows read or synced since the last import are fetched,
+// unless books were added or removed and a full reload is needed.
+class LibraryImporter
+{
+    public:
+        explicit LibraryImporter(const QString &databasePath = KOBO_DATABASE_PATH);
+
+        bool importBooks(QString *error = nullptr);
+        bool changed() const { return m_changed; }
+
+    private:
+        QString m_databasePath;
+        bool m_changed = false;
+};
+
+#endif // LIBRARY_IMPORTER_H
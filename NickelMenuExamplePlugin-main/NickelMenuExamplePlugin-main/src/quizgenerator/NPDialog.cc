@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QChildEvent>
 #include <QComboBox>
 #include <QRect>
 #include <QScreen>
@@ -6,7 +7,10 @@
 
 #include "NPDialog.h"
 
-const char touchFilterSet[] = "touchFilterSet";
+// Finger travel below this many pixels between moves is not forwarded
+static const int MOVE_STEP = 16;
+// Swipes must be quick; a slow drag is treated as a tap or a press
+static const int SWIPE_MAX_MSECS = 800;
 
 NPDialog::NPDialog(QWidget *parent) : QDialog(parent)
 {
@@ -20,45 +24,109 @@ NPDialog::NPDialog(QWidget *parent) : QDialog(parent)
     // Make sure dialog stays on top and covers the full screen
     setWindowFlags(Qt::Dialog | Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
     setWindowState(Qt::WindowFullScreen);
+
+    // Children pick up the filter as they are added, see eventFilter
+    installEvFilter(this);
 }
 
 bool NPDialog::eventFilter(QObject *obj, QEvent *event)
 {
     auto type = event->type();
+    if (type == QEvent::ChildAdded) {
+        // A new child is still under construction: it only gets the filter
+        // now and accepts touches once polished. Its own children are then
+        // reported to it in turn. A finished widget moved in from elsewhere
+        // is set up completely, together with its children.
+        QObject *child = static_cast<QChildEvent*>(event)->child();
+        if (child->isWidgetType()) {
+            QWidget *widget = static_cast<QWidget*>(child);
+            if (widget->testAttribute(Qt::WA_WState_Polished)) {
+                installEvFilter(widget);
+                for (QWidget *w : widget->findChildren<QWidget*>()) {
+                    installEvFilter(w);
+                }
+            } else {
+                widget->installEventFilter(this);
+            }
+        }
+        return false;
+    }
+    if (type == QEvent::Polish) {
+        static_cast<QWidget*>(obj)->setAttribute(Qt::WA_AcceptTouchEvents);
+        return false;
+    }
+
+    if (type == QEvent::TouchCancel) {
+        // The system took the touch back: drop the press without a click so
+        // the next touch starts clean
+        event->accept();
+        if (m_touchTarget) {
+            sendMouse(m_touchTarget, QEvent::MouseButtonRelease, QPointF(-1, -1), m_lastMove);
+        }
+        m_touchTarget = nullptr;
+        m_touchStart = QPointF();
+        m_lastMove = QPointF();
+        m_touchTimer.invalidate();
+        return true;
+    }
+
     if (type == QEvent::TouchBegin || type == QEvent::TouchUpdate || type == QEvent::TouchEnd) {
         event->accept();
-        auto tp = static_cast<QTouchEvent*>(event)->touchPoints().at(0);
+        const QTouchEvent::TouchPoint &tp = static_cast<QTouchEvent*>(event)->touchPoints().at(0);
         if (type == QEvent::TouchBegin) {
-            QMouseEvent md(QEvent::MouseButtonPress, tp.pos(), tp.screenPos(), Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
-            QApplication::sendEvent(obj, &md);
+            m_touchStart = tp.screenPos();
+            m_lastMove = m_touchStart;
+            m_touchTimer.start();
+            m_touchTarget = obj;
+            sendMouse(obj, QEvent::MouseButtonPress, tp.pos(), tp.screenPos());
         } else if (type == QEvent::TouchUpdate) {
-            QMouseEvent mm(QEvent::MouseMove, tp.pos(), tp.screenPos(), Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
-            QApplication::sendEvent(obj, &mm);
-        } else if (type == QEvent::TouchEnd) {
-            QMouseEvent mu(QEvent::MouseButtonRelease, tp.pos(), tp.screenPos(), Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
-            QApplication::sendEvent(obj, &mu);
+            // Coalesce the stream of updates into coarse moves
+            if ((tp.screenPos() - m_lastMove).manhattanLength() >= MOVE_STEP) {
+                m_lastMove = tp.screenPos();
+                sendMouse(obj, QEvent::MouseMove, tp.pos(), tp.screenPos());
+            }
+        } else {
+            m_touchTarget = nullptr;
+            QPointF delta = tp.screenPos() - m_touchStart;
+            qreal dx = qAbs(delta.x());
+            qreal dy = qAbs(delta.y());
+            int minDistance = qMax(60, width() / 8);
+            bool swipe = m_touchTimer.elapsed() <= SWIPE_MAX_MSECS
+                && qMax(dx, dy) >= minDistance
+                && (dx >= 2 * dy || dy >= 2 * dx);
+
+            if (!swipe) {
+                sendMouse(obj, QEvent::MouseButtonRelease, tp.pos(), tp.screenPos());
+            } else {
+                // Release outside the widget so the press does not turn into a click
+                sendMouse(obj, QEvent::MouseButtonRelease, QPointF(-1, -1), tp.screenPos());
+                if (dx > dy) {
+                    emit swiped(delta.x() < 0 ? SwipeLeft : SwipeRight);
+                } else {
+                    emit swiped(delta.y() < 0 ? SwipeUp : SwipeDown);
+                }
+            }
         }
         return true;
     }
     return false;
 }
 
+void NPDialog::sendMouse(QObject *obj, QEvent::Type type, const QPointF &pos, const QPointF &screenPos)
+{
+    Qt::MouseButtons buttons = type == QEvent::MouseButtonRelease ? Qt::NoButton : Qt::LeftButton;
+    QMouseEvent me(type, pos, screenPos, Qt::LeftButton, buttons, Qt::NoModifier);
+    QApplication::sendEvent(obj, &me);
+}
+
 void NPDialog::installEvFilter(QWidget *w)
 {
-    if (!w->property(touchFilterSet).isValid()) {
-        w->setProperty(touchFilterSet, QVariant(true));
-        w->setAttribute(Qt::WA_AcceptTouchEvents);
-        w->installEventFilter(this);
-    }
+    // Installing the same filter again only moves it to the front
+    w->setAttribute(Qt::WA_AcceptTouchEvents);
+    w->installEventFilter(this);
 }
 
 void NPDialog::showDlg()
 {
-    auto children = findChildren<QWidget*>();
-    for (int i = 0; i < children.size(); ++i) {
-        if (auto wi = children.at(i)) {
-            installEvFilter(wi);
-        }
-    }
     open();
-}
\ No newline at end of file
+}
@@ -2,19 +2,35 @@
 #define NP_DIALOG_HPP
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QPointer>
 
 class NPDialog : public QDialog
 {
     Q_OBJECT
     public:
+        enum SwipeDirection { SwipeLeft, SwipeRight, SwipeUp, SwipeDown };
+
         NPDialog(QWidget* parent = nullptr);
         ~NPDialog() = default;
         void showDlg();
 
+    signals:
+        // A touch that travelled far and fast enough; it does not click
+        void swiped(NPDialog::SwipeDirection direction);
+
     protected:
         bool eventFilter(QObject *obj, QEvent *event) override;
     private:
         void installEvFilter(QWidget *w);
+        void sendMouse(QObject *obj, QEvent::Type type, const QPointF &pos, const QPointF &screenPos);
+
+        // State of the touch in progress
+        QPointF m_touchStart;
+        QPointF m_lastMove;
+        QElapsedTimer m_touchTimer;
+        QPointer<QObject> m_touchTarget;   // Widget that got the press
 };
 
-#endif // NP_DIALOG_HPP
\ No newline at end of file
+#endif // NP_DIALOG_HPP
@@ -0,0 +1,118 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "PromptTemplate.h"
+
+PromptTemplate::PromptTemplate(const QString &path)
+    : m_path(path)
+{
+}
+
+bool PromptTemplate::load()
+{
+    QFileInfo info(m_path);
+    if (!info.exists()) {
+        m_user.clear();
+        m_size = -1;
+        return false;
+    }
+    if (info.lastModified() == m_modified && info.size() == m_size) {
+        return !m_user.isEmpty();
+    }
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    // The system and user sections follow their marker lines
+    QString systemText, userText;
+    QString *target = nullptr;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (line.contains("===SYSTEM_PROMPT===")) {
+            target = &systemText;
+        } else if (line.contains("===USER_PROMPT===")) {
+            target = &userText;
+        } else if (target) {
+            target->append(line);
+            target->append('\n');
+        }
+    }
+
+    m_system = compile(systemText.trimmed());
+    m_user = compile(userText.trimmed());
+    m_modified = info.lastModified();
+    m_size = info.size();
+    return !m_user.isEmpty();
+}
+
+bool PromptTemplate::userHas(const QString &name) const
+{
+    for (const Piece &piece : m_user) {
+        if (piece.placeholder && piece.text == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Only {lower_case_name} is a placeholder, so the braces of a JSON example
+// in the prompt stay literal
+QVector<PromptTemplate::Piece> PromptTemplate::compile(const QString &text)
+{
+    QVector<Piece> pieces;
+    int literalStart = 0;
+    int i = 0;
+    while (i < text.size()) {
+        if (text.at(i) != '{') {
+            ++i;
+            continue;
+        }
+
+        int end = i + 1;
+        while (end < text.size() && (text.at(end).isLower() || text.at(end) == '_')) {
+            ++end;
+        }
+        if (end == i + 1 || end >= text.size() || text.at(end) != '}') {
+            ++i;
+            continue;
+        }
+
+        if (i > literalStart) {
+            pieces.append({ text.mid(literalStart, i - literalStart), false });
+        }
+        pieces.append({ text.mid(i + 1, end - i - 1), true });
+        i = end + 1;
+        literalStart = i;
+    }
+    if (literalStart < text.size()) {
+        pieces.append({ text.mid(literalStart), false });
+    }
+    return pieces;
+}
+
+QString PromptTemplate::render(const QVector<Piece> &pieces, const QHash<QString, QString> &values)
+{
+    int size = 0;
+    for (const Piece &piece : pieces) {
+        size += piece.placeholder ? values.value(piece.text).size() : piece.text.size();
+    }
+
+    // Unknown placeholders are left as they were written
+    QString result;
+    result.reserve(size);
+    for (const Piece &piece : pieces) {
+        if (!piece.placeholder) {
+            result += piece.text;
+        } else if (values.contains(piece.text)) {
+            result += values.value(piece.text);
+        } else {
+            result += '{' + piece.text + '}';
+        }
+    }
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef PROMPT_TEMPLATE_H
+#define PROMPT_TEMPLATE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// prompts.txt compiled into literal text and named placeholders such as
+// {book_title}, {author}, {count} and {excerpt}. The file is parsed again
+// only when its mtime or size changes, so rendering a prompt is a single
+// pass over the pieces. Values are inserted as plain text; escaping is
+// left to whatever serialises the request.
+class PromptTemplate
+{
+    public:
+        explicit PromptTemplate(const QString &path);
+
+        // Re-reads the file if it changed; false if it has no user prompt
+        bool load();
+
+        QString system(const QHash<QString, QString> &values) const { return render(m_system, values); }
+        QString user(const QHash<QString, QString> &values) const { return render(m_user, values); }
+        bool userHas(const QString &name) const;
+
+    private:
+        // A placeholder keeps its name in `text`
+        struct Piece {
+            QString text;
+            bool placeholder;
+        };
+
+        static QVector<Piece> compile(const QString &text);
+        static QString render(const QVector<Piece> &pieces, const QHash<QString, QString> &values);
+
+        QString m_path;
+        QDateTime m_modified;
+        qint64 m_size = -1;
+        QVector<Piece> m_system;
+        QVector<Piece> m_user;
+};
+
+#endif // PROMPT_TEMPLATE_H
@@ -0,0 +1,312 @@
+#include <QDataStream>
+#include <QDate>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+#include "QuestionBank.h"
+
+static const quint32 SCHEDULE_MAGIC = 0x515a5153; // "QZQS"
+static const quint32 SCHEDULE_VERSION = 2;
+static const int HEADER_SIZE = 8;
+static const int RECORD_SIZE = 24;
+
+static quint32 today()
+{
+    return quint32(QDate::currentDate().toJulianDay());
+}
+
+// FNV-1a, stable across runs unlike qHash, because hashes are stored
+static quint32 questionHash(const QString &book, const QString &question)
+{
+    quint32 hash = 2166136261u;
+    for (char c : (book + QChar(0) + question).toUtf8()) {
+        hash = (hash ^ quint8(c)) * 16777619u;
+    }
+    return hash;
+}
+
+QuestionBank::QuestionBank(const QString &itemsPath, const QString &schedulePath)
+    : m_items(itemsPath)
+    , m_schedule(schedulePath)
+{
+}
+
+int QuestionBank::count()
+{
+    return load() ? m_records.size() : 0;
+}
+
+int QuestionBank::dueCount()
+{
+    if (!load()) {
+        return 0;
+    }
+
+    quint32 now = today();
+    int due = 0;
+    for (const Schedule &record : m_records) {
+        if (record.due <= now) {
+            ++due;
+        }
+    }
+    return due;
+}
+
+QList<int> QuestionBank::dueQuestions(int limit)
+{
+    QList<int> result;
+    if (!load() || limit <= 0) {
+        return result;
+    }
+
+    quint32 now = today();
+    QVector<int> due;
+    for (int id = 0; id < m_records.size(); ++id) {
+        if (m_records.at(id).due <= now) {
+            due.append(id);
+        }
+    }
+
+    // Longest overdue first; among equals the harder questions
+    int n = qMin(limit, due.size());
+    std::partial_sort(due.begin(), due.begin() + n, due.end(), [this](int a, int b) {
+        const Schedule &ra = m_records.at(a);
+        const Schedule &rb = m_records.at(b);
+        return ra.due < rb.due || (ra.due == rb.due && ra.ease < rb.ease);
+    });
+    for (int i = 0; i < n; ++i) {
+        result.append(due.at(i));
+    }
+    return result;
+}
+
+bool QuestionBank::question(int id, QuizItem *item, QString *book)
+{
+    return load() && id >= 0 && id < m_records.size()
+        && readItem(m_records.at(id).offset, item, book);
+}
+
+bool QuestionBank::readItem(quint32 offset, QuizItem *item, QString *book)
+{
+    if (!m_items.seek(offset)) {
+        return false;
+    }
+
+    QDataStream in(&m_items);
+    in.setVersion(QDataStream::Qt_5_0);
+    QString storedBook;
+    in >> storedBook >> item->question >> item->options >> item->correctAnswer >> item->explanation;
+    if (book) {
+        *book = storedBook;
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+int QuestionBank::add(const QString &book, const QuizItem &item)
+{
+    if (!load()) {
+        return -1;
+    }
+
+    quint32 hash = questionHash(book, item.question);
+    int id = find(book, item, hash);
+    if (id < 0) {
+        id = append(book, item, hash);
+        if (id >= 0) {
+            writeSchedule(id);
+        }
+    }
+    return id;
+}
+
+void QuestionBank::recordAnswer(int id, bool correct)
+{
+    if (!load() || id < 0 || id >= m_records.size()) {
+        return;
+    }
+
+    // SM-2 with a correct answer graded 4 and a wrong one 1
+    Schedule &record = m_records[id];
+    int quality = correct ? 4 : 1;
+    if (quality >= 3) {
+        if (record.repetitions == 0) {
+            record.interval = 1;
+        } else if (record.repetitions == 1) {
+            record.interval = 6;
+        } else {
+            record.interval = quint16(qMin(3650, qRound(record.interval * record.ease / 100.0)));
+        }
+        record.repetitions++;
+    } else {
+        record.repetitions = 0;
+        record.interval = 1;
+        record.lapses++;
+    }
+
+    int penalty = 5 - quality;
+    int ease = record.ease + 10 - penalty * (8 + penalty * 2);
+    record.ease = quint16(qMax(130, ease));
+    record.reviewed = today();
+    record.due = record.reviewed + record.interval;
+
+    writeSchedule(id);
+}
+
+bool QuestionBank::load()
+{
+    if (m_loaded) {
+        return true;
+    }
+
+    QDir().mkpath(QFileInfo(m_items.fileName()).absolutePath());
+    if (!m_items.open(QIODevice::ReadWrite) || !m_schedule.open(QIODevice::ReadWrite)) {
+        qWarning() << "QuestionBank: unable to open" << m_items.fileName() << m_schedule.fileName();
+        m_items.close();
+        m_schedule.close();
+        return false;
+    }
+
+    // A schedule from before the header was added holds qHash values,
+    // which change between runs; its records are kept and rehashed
+    QByteArray data = m_schedule.readAll();
+    QDataStream in(data);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    bool current = in.status() == QDataStream::Ok && magic == SCHEDULE_MAGIC
+        && version == SCHEDULE_VERSION;
+    int start = current ? HEADER_SIZE : 0;
+    if (!current) {
+        in.device()->seek(0);
+        in.resetStatus();
+    }
+
+    // A record whose item did not make it to disk is dropped, as is a
+    // partially written trailing record
+    qint64 itemsSize = m_items.size();
+    int records = (data.size() - start) / RECORD_SIZE;
+    m_records.reserve(records);
+    for (int i = 0; i < records; ++i) {
+        Schedule record;
+        in >> record.offset >> record.hash >> record.due >> record.reviewed
+           >> record.interval >> record.ease >> record.repetitions >> record.lapses;
+        if (record.offset >= itemsSize) {
+            break;
+        }
+        m_records.append(record);
+    }
+
+    if (!current) {
+        for (Schedule &record : m_records) {
+            QuizItem item;
+            QString book;
+            readItem(record.offset, &item, &book);
+            record.hash = questionHash(book, item.question);
+        }
+        if (!rewriteSchedule()) {
+            m_records.clear();
+            m_items.close();
+            m_schedule.close();
+            return false;
+        }
+    } else if (HEADER_SIZE + m_records.size() * qint64(RECORD_SIZE) != data.size()) {
+        m_schedule.resize(HEADER_SIZE + m_records.size() * qint64(RECORD_SIZE));
+    }
+
+    for (int id = 0; id < m_records.size(); ++id) {
+        m_byHash.insert(m_records.at(id).hash, id);
+    }
+    m_loaded = true;
+    return true;
+}
+
+void QuestionBank::writeRecord(QDataStream &out, const Schedule &record)
+{
+    out << record.offset << record.hash << record.due << record.reviewed
+        << record.interval << record.ease << record.repetitions << record.lapses;
+}
+
+// Writes the header and every record to a new file, then reopens it
+bool QuestionBank::rewriteSchedule()
+{
+    QSaveFile file(m_schedule.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out << SCHEDULE_MAGIC << SCHEDULE_VERSION;
+    for (const Schedule &record : m_records) {
+        writeRecord(out, record);
+    }
+    m_schedule.close();
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "QuestionBank: unable to write" << m_schedule.fileName();
+        return false;
+    }
+    return m_schedule.open(QIODevice::ReadWrite);
+}
+
+int QuestionBank::find(const QString &book, const QuizItem &item, quint32 hash)
+{
+    // Hashes can collide, so compare against the stored question
+    for (QMultiHash<quint32, int>::const_iterator it = m_byHash.constFind(hash);
+            it != m_byHash.constEnd() && it.key() == hash; ++it) {
+        QuizItem stored;
+        QString storedBook;
+        if (question(it.value(), &stored, &storedBook)
+                && storedBook == book && stored.question == item.question) {
+            return it.value();
+        }
+    }
+    return -1;
+}
+
+int QuestionBank::append(const QString &book, const QuizItem &item, quint32 hash)
+{
+    qint64 offset = m_items.size();
+    if (offset > qint64(0xffffffffu) || !m_items.seek(offset)) {
+        return -1;
+    }
+
+    QDataStream out(&m_items);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << book << item.question << item.options << item.correctAnswer << item.explanation;
+    if (out.status() != QDataStream::Ok || !m_items.flush()) {
+        m_items.resize(offset);
+        return -1;
+    }
+
+    // New questions start as SM-2 cards that were never reviewed
+    Schedule record;
+    record.offset = quint32(offset);
+    record.hash = hash;
+    record.due = today();
+    record.reviewed = 0;
+    record.interval = 0;
+    record.ease = 250;
+    record.repetitions = 0;
+    record.lapses = 0;
+
+    int id = m_records.size();
+    m_records.append(record);
+    m_byHash.insert(hash, id);
+    return id;
+}
+
+bool QuestionBank::writeSchedule(int id)
+{
+    const Schedule &record = m_records.at(id);
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    writeRecord(out, record);
+
+    if (!m_schedule.seek(HEADER_SIZE + id * qint64(RECORD_SIZE)) || m_schedule.write(data) != RECORD_SIZE
+            || !m_schedule.flush()) {
+        qWarning() << "QuestionBank: unable to write" << m_schedule.fileName();
+        return false;
+    }
+    return true;
+}
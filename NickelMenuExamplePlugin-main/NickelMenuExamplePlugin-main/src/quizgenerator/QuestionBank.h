@@ -0,0 +1,68 @@
+#ifndef QUESTION_BANK_H
+#define QUESTION_BANK_H
+
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QMultiHash>
+#include <QString>
+#include <QVector>
+
+#include "QuizConfig.h"
+#include "QuizItem.h"
+
+const QString BANK_ITEMS_PATH = ONBOARD_ROOT + "/.adds/quiz/bank.items";
+const QString BANK_SCHEDULE_PATH = ONBOARD_ROOT + "/.adds/quiz/bank.schedule";
+
+// Every question the user has been shown, scheduled for review with SM-2.
+// Questions are appended to an items file once and never rewritten. The
+// schedule file holds a versioned header, then one fixed-size record per
+// question, which points into the items file and is updated in place after
+// each answer. Only the schedule is kept in memory, so picking due
+// questions is a scan over a small array however many questions are stored.
+class QuestionBank
+{
+    public:
+        explicit QuestionBank(const QString &itemsPath = BANK_ITEMS_PATH,
+                              const QString &schedulePath = BANK_SCHEDULE_PATH);
+
+        int count();
+        int dueCount();
+
+        // Ids of due questions, most overdue first
+        QList<int> dueQuestions(int limit);
+        bool question(int id, QuizItem *item, QString *book = nullptr);
+
+        // Stores a question the first time it is seen, due today; returns its
+        // id, or -1 when the bank cannot be written
+        int add(const QString &book, const QuizItem &item);
+        void recordAnswer(int id, bool correct);
+
+    private:
+        struct Schedule {
+            quint32 offset;     // Record position in the items file
+            quint32 hash;       // Of book and question, to find duplicates
+            quint32 due;        // Julian day
+            quint32 reviewed;   // Julian day of the last answer
+            quint16 interval;   // Days
+            quint16 ease;       // SM-2 easiness factor x 100
+            quint16 repetitions;
+            quint16 lapses;
+        };
+
+        bool load();
+        bool readItem(quint32 offset, QuizItem *item, QString *book);
+        bool rewriteSchedule();
+        static void writeRecord(QDataStream &out, const Schedule &record);
+        int find(const QString &book, const QuizItem &item, quint32 hash);
+        int append(const QString &book, const QuizItem &item, quint32 hash);
+        bool writeSchedule(int id);
+
+        QFile m_items;
+        QFile m_schedule;
+        QVector<Schedule> m_records;
+        QMultiHash<quint32, int> m_byHash;
+        bool m_loaded = false;
+};
+
+#endif // QUESTION_BANK_H
@@ -0,0 +1,218 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include "QuestionFingerprints.h"
+
+static const quint32 SEEN_MAGIC = 0x515a5351; // "QZSQ"
+static const quint32 SEEN_VERSION = 1;
+
+// Stable across runs, unlike qHash, because signatures are stored
+static quint32 fnv1a(const QByteArray &data)
+{
+    quint32 hash = 2166136261u;
+    for (char c : data) {
+        hash = (hash ^ quint8(c)) * 16777619u;
+    }
+    return hash;
+}
+
+static quint32 mix(quint32 h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+QuestionFingerprints::QuestionFingerprints(const QString &dir)
+    : m_dir(dir)
+{
+}
+
+QString QuestionFingerprints::filePath(const QString &bookTitle) const
+{
+    QByteArray hash = QCryptographicHash::hash(bookTitle.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_dir + "/" + QString::fromLatin1(hash) + ".seen";
+}
+
+quint64 QuestionFingerprints::bandKey(const Signature &sig, int band)
+{
+    quint64 rows = quint64(sig.h[band * ROWS]) << 32 | sig.h[band * ROWS + 1];
+    return rows ^ (quint64(band) * 0x9e3779b97f4a7c15ull);
+}
+
+QuestionFingerprints::Signature QuestionFingerprints::signature(const QuizItem &item)
+{
+    // Lower-case words; pairs of them keep a little of the word order
+    QString text = (item.question + " " + item.correctAnswer).toLower();
+    QStringList words;
+    QString word;
+    for (QChar c : text) {
+        if (c.isLetterOrNumber()) {
+            word += c;
+        } else if (!word.isEmpty()) {
+            words.append(word);
+            word.clear();
+        }
+    }
+    if (!word.isEmpty()) {
+        words.append(word);
+    }
+
+    QVector<quint32> shingles;
+    for (int i = 0; i + 1 < words.size(); ++i) {
+        shingles.append(fnv1a((words.at(i) + " " + words.at(i + 1)).toUtf8()));
+    }
+    if (shingles.isEmpty() && !words.isEmpty()) {
+        shingles.append(fnv1a(words.first().toUtf8()));
+    }
+
+    Signature result;
+    for (int i = 0; i < HASHES; ++i) {
+        quint32 seed = mix(quint32(i + 1) * 0x9e3779b9u);
+        quint32 minimum = 0xffffffffu;
+        for (quint32 shingle : shingles) {
+            minimum = qMin(minimum, mix(shingle ^ seed));
+        }
+        result.h[i] = minimum;
+    }
+    return result;
+}
+
+bool QuestionFingerprints::remember(const QString &bookTitle, const QuizItem &item)
+{
+    if (!load(bookTitle)) {
+        return true;
+    }
+
+    Signature sig = signature(item);
+    if (m_threshold > 0 && matches(sig)) {
+        return false;
+    }
+
+    QDir().mkpath(m_dir);
+    QFile file(filePath(bookTitle));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "QuestionFingerprints: unable to write" << file.fileName();
+    } else {
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_5_0);
+        if (file.size() == 0) {
+            out << SEEN_MAGIC << SEEN_VERSION;
+        }
+        for (int i = 0; i < HASHES; ++i) {
+            out << sig.h[i];
+        }
+        out << item.question;
+    }
+
+    index(sig);
+    m_questions.append(item.question);
+    return true;
+}
+
+QStringList QuestionFingerprints::recent(const QString &bookTitle, int limit)
+{
+    QStringList result;
+    if (!load(bookTitle)) {
+        return result;
+    }
+    for (int i = m_questions.size() - 1; i >= 0 && result.size() < limit; --i) {
+        result.append(m_questions.at(i));
+    }
+    return result;
+}
+
+bool QuestionFingerprints::load(const QString &bookTitle)
+{
+    if (bookTitle.isEmpty()) {
+        return false;
+    }
+    if (bookTitle == m_book) {
+        return true;
+    }
+
+    m_book = bookTitle;
+    m_signatures.clear();
+    m_questions.clear();
+    m_bands.clear();
+
+    QFile file(filePath(bookTitle));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return true;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != SEEN_MAGIC || version != SEEN_VERSION) {
+        return true;
+    }
+
+    qint64 whole = file.pos();
+    while (!in.atEnd()) {
+        Signature sig;
+        QString question;
+        for (int i = 0; i < HASHES; ++i) {
+            in >> sig.h[i];
+        }
+        in >> question;
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+        index(sig);
+        m_questions.append(question);
+        whole = file.pos();
+    }
+
+    // A partially written trailing record is cut off, or every record
+    // appended after it would be read out of step
+    if (whole < file.size()) {
+        file.close();
+        qWarning() << "QuestionFingerprints: dropping a damaged record in" << file.fileName();
+        if (!file.resize(whole)) {
+            qWarning() << "QuestionFingerprints: unable to truncate" << file.fileName();
+        }
+    }
+    return true;
+}
+
+bool QuestionFingerprints::matches(const Signature &sig)
+{
+    for (int band = 0; band < HASHES / ROWS; ++band) {
+        quint64 key = bandKey(sig, band);
+        QHash<quint64, QVector<int>>::const_iterator it = m_bands.constFind(key);
+        if (it == m_bands.constEnd()) {
+            continue;
+        }
+
+        // Candidates share a band; the full signature estimates similarity
+        for (int id : it.value()) {
+            const Signature &other = m_signatures.at(id);
+            int same = 0;
+            for (int i = 0; i < HASHES; ++i) {
+                same += sig.h[i] == other.h[i];
+            }
+            if (same * 100 >= m_threshold * HASHES) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void QuestionFingerprints::index(const Signature &sig)
+{
+    int id = m_signatures.size();
+    m_signatures.append(sig);
+    for (int band = 0; band < HASHES / ROWS; ++band) {
+        quint64 key = bandKey(sig, band);
+        m_bands[key].append(id);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef QUESTION_FINGERPRINTS_H
+#define QUESTION_FINGERPRINTS_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "QuizConfig.h"
+#include "QuizItem.h"
+
+const QString SEEN_QUESTIONS_DIR = ONBOARD_ROOT + "/.adds/quiz/seen";
+
+// Remembers every question generated for a book, as a MinHash signature
+// over word pairs of the question and its answer, so reworded repeats can
+// be recognised. Signatures are banded into a hash table (LSH): a lookup
+// only compares the few earlier questions that share a band, however
+// long the history. Each book has its own append-only file, loaded the
+// first time the book is asked about.
+class QuestionFingerprints
+{
+    public:
+        explicit QuestionFingerprints(const QString &dir = SEEN_QUESTIONS_DIR);
+
+        // Estimated share of word pairs, in percent, at which a question
+        // counts as a repeat; 0 turns the check off
+        void setThreshold(int percent) { m_threshold = percent; }
+
+        // Adds a question unless it repeats one already seen
+        bool remember(const QString &bookTitle, const QuizItem &item);
+
+        // The latest questions for a book, newest first
+        QStringList recent(const QString &bookTitle, int limit);
+
+    private:
+        enum { HASHES = 16, ROWS = 2 };
+        struct Signature {
+            quint32 h[HASHES];
+        };
+
+        static Signature signature(const QuizItem &item);
+        static quint64 bandKey(const Signature &sig, int band);
+        QString filePath(const QString &bookTitle) const;
+        bool load(const QString &bookTitle);
+        bool matches(const Signature &signature);
+        void index(const Signature &signature);
+
+        QString m_dir;
+        int m_threshold = 60;
+
+        // Only the most recently used book is kept in memory
+        QString m_book;
+        QVector<Signature> m_signatures;
+        QStringList m_questions;
+        QHash<quint64, QVector<int>> m_bands;
+};
+
+#endif // QUESTION_FINGERPRINTS_H
@@ -0,0 +1,189 @@
+#include <QDebug>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtNetwork/QSslSocket>
+
+#include "QuizBackend.h"
+#include "QuizConfig.h"
+#include "QuizNetwork.h"
+
+// Requests in flight per backend name, across all clients
+static QHash<QString, int> s_inFlight;
+
+namespace {
+
+// Azure OpenAI: the deployment URL carries the model and api-version
+class AzureBackend : public QuizBackend
+{
+    public:
+        explicit AzureBackend(const QuizConfig &config)
+            : QuizBackend("azure", config, 90, 30, 2)
+        {
+            m_url = QUrl(setting(config, "URL", config.value("OPENAI_API_URL")));
+            m_key = setting(config, "API_KEY", config.value("OPENAI_API_KEY"));
+        }
+
+    protected:
+        void authorize(QNetworkRequest &request) const override
+        {
+            request.setRawHeader("api-key", m_key.toUtf8());
+        }
+};
+
+// api.openai.com or any service that speaks the same protocol
+class OpenAIBackend : public QuizBackend
+{
+    public:
+        explicit OpenAIBackend(const QuizConfig &config)
+            : QuizBackend("openai", config, 90, 30, 2)
+        {
+            m_url = QUrl(setting(config, "URL", "https://api.openai.com/v1/chat/completions"));
+            m_key = setting(config, "API_KEY", config.value("OPENAI_API_KEY"));
+            m_model = setting(config, "MODEL", "gpt-4o-mini");
+        }
+
+    protected:
+        void authorize(QNetworkRequest &request) const override
+        {
+            request.setRawHeader("Authorization", "Bearer " + m_key.toUtf8());
+        }
+};
+
+// An OpenAI-compatible model server on the LAN or this machine, such as
+// llama.cpp or Ollama. Slow hardware gets generous timeouts, and one
+// request at a time keeps it from thrashing.
+class LocalBackend : public QuizBackend
+{
+    public:
+        explicit LocalBackend(const QuizConfig &config)
+            : QuizBackend("local", config, 300, 120, 1)
+        {
+            m_url = QUrl(setting(config, "URL", "http://127.0.0.1:8080/v1/chat/completions"));
+            m_key = setting(config, "API_KEY");
+            m_model = setting(config, "MODEL");
+        }
+
+    protected:
+        void authorize(QNetworkRequest &request) const override
+        {
+            if (!m_key.isEmpty()) {
+                request.setRawHeader("Authorization", "Bearer " + m_key.toUtf8());
+            }
+        }
+
+        bool needsKey() const override { return false; }
+};
+
+}
+
+QuizBackend* QuizBackend::create(const QString &name, const QuizConfig &config)
+{
+    if (name == "openai") {
+        return new OpenAIBackend(config);
+    }
+    if (name == "local") {
+        return new LocalBackend(config);
+    }
+    if (name.isEmpty() || name == "azure") {
+        return new AzureBackend(config);
+    }
+    qWarning() << "QuizBackend: unknown backend" << name;
+    return nullptr;
+}
+
+QuizBackend::QuizBackend(const QString &name, const QuizConfig &config,
+                         int defaultTimeoutSecs, int defaultStallSecs, int defaultConcurrency)
+    : m_name(name)
+{
+    QString prefix = "QUIZ_" + name.toUpper() + "_";
+    m_timeoutSecs = qMax(5, config.intValue(prefix + "TIMEOUT_SECS",
+                                            config.intValue("QUIZ_TIMEOUT_SECS", defaultTimeoutSecs)));
+    m_stallSecs = qMax(0, config.intValue(prefix + "STALL_SECS",
+                                          config.intValue("QUIZ_STALL_SECS", defaultStallSecs)));
+    m_concurrency = qMax(1, config.intValue(prefix + "CONCURRENCY", defaultConcurrency));
+}
+
+QuizBackend::~QuizBackend()
+{
+    release();
+}
+
+QString QuizBackend::setting(const QuizConfig &config, const char *key, const QString &defaultValue) const
+{
+    QString value = config.value("QUIZ_" + m_name.toUpper() + "_" + key);
+    return value.isEmpty() ? defaultValue : value;
+}
+
+bool QuizBackend::isUsable(QString *reason) const
+{
+    if (!m_url.isValid() || m_url.isEmpty()) {
+        *reason = "no URL configured";
+        return false;
+    }
+    if (needsKey() && m_key.isEmpty()) {
+        *reason = "no API key configured";
+        return false;
+    }
+    if (m_url.scheme() == "https" && !QSslSocket::supportsSsl()) {
+        *reason = "no SSL support";
+        return false;
+    }
+    return true;
+}
+
+QNetworkRequest QuizBackend::request() const
+{
+    QNetworkRequest request(m_url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Accept", "text/event-stream");
+    authorize(request);
+    QuizNetwork::prepare(request);
+    return request;
+}
+
+QByteArray QuizBackend::body(const QString &systemPrompt, const QString &userPrompt) const
+{
+    QJsonObject systemMessage;
+    systemMessage["role"] = QString("system");
+    systemMessage["content"] = systemPrompt;
+    QJsonObject userMessage;
+    userMessage["role"] = QString("user");
+    userMessage["content"] = userPrompt;
+
+    QJsonArray messages;
+    messages.append(systemMessage);
+    messages.append(userMessage);
+
+    QJsonObject body;
+    if (!m_model.isEmpty()) {
+        body["model"] = m_model;
+    }
+    body["messages"] = messages;
+    body["temperature"] = 0.7;
+    body["stream"] = true;
+    return QJsonDocument(body).toJson(QJsonDocument::Compact);
+}
+
+bool QuizBackend::acquire()
+{
+    if (m_holding) {
+        return true;
+    }
+    int &inFlight = s_inFlight[m_name];
+    if (inFlight >= m_concurrency) {
+        return false;
+    }
+    ++inFlight;
+    m_holding = true;
+    return true;
+}
+
+void QuizBackend::release()
+{
+    if (m_holding) {
+        m_holding = false;
+        --s_inFlight[m_name];
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef QUIZ_BACKEND_H
+#define QUIZ_BACKEND_H
+
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <QtNetwork/QNetworkRequest>
+
+class QuizConfig;
+
+// A chat-completions service the quiz client can stream questions from.
+// Backends differ in endpoint, authentication and request fields, and each
+// has its own timeouts and a limit on requests in flight at once, shared
+// by every QuizClient in the process. Settings are read from .env under
+// the backend's prefix (QUIZ_AZURE_, QUIZ_OPENAI_, QUIZ_LOCAL_) and fall
+// back to the general QUIZ_TIMEOUT_SECS and QUIZ_STALL_SECS.
+class QuizBackend
+{
+    public:
+        virtual ~QuizBackend();
+
+        // "azure" (also when unset), "openai" or "local"; nullptr otherwise
+        static QuizBackend* create(const QString &name, const QuizConfig &config);
+
+        const QString& name() const { return m_name; }
+        const QUrl& url() const { return m_url; }
+        bool isUsable(QString *reason) const;
+
+        int timeoutMs() const { return m_timeoutSecs * 1000; }
+        qint64 stallMs() const { return m_stallSecs * 1000LL; }
+
+        QNetworkRequest request() const;
+        QByteArray body(const QString &systemPrompt, const QString &userPrompt) const;
+
+        // A free request slot; false means wait until one is released
+        bool acquire();
+        void release();
+
+    protected:
+        QuizBackend(const QString &name, const QuizConfig &config,
+                    int defaultTimeoutSecs, int defaultStallSecs, int defaultConcurrency);
+
+        virtual void authorize(QNetworkRequest &request) const = 0;
+        virtual bool needsKey() const { return true; }
+
+        QString setting(const QuizConfig &config, const char *key, const QString &defaultValue = QString()) const;
+
+        QString m_name;
+        QUrl m_url;
+        QString m_key;
+        QString m_model;
+
+    private:
+        int m_timeoutSecs;
+        int m_stallSecs;
+        int m_concurrency;
+        bool m_holding = false;
+};
+
+#endif // QUIZ_BACKEND_H
@@ -0,0 +1,124 @@
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <utime.h>
+
+#include "QuizCache.h"
+#include "QuizClient.h"
+
+QuizCache::QuizCache(const QString &dir)
+    : m_dir(dir)
+{
+}
+
+void QuizCache::setLimits(int maxEntries, qint64 maxBytes)
+{
+    m_maxEntries = qMax(1, maxEntries);
+    m_maxBytes = qMax<qint64>(1024, maxBytes);
+}
+
+bool QuizCache::lookup(const QString &bookTitle, QList<QuizItem> &items)
+{
+    QString path = entryPath(bookTitle);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QList<QuizItem> cached;
+    if (!QuizClient::parseQuizItems(file.readAll(), cached) || cached.isEmpty()) {
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    // Bump the entry to most recently used
+    utime(QFile::encodeName(path).constData(), nullptr);
+
+    items = cached;
+    return true;
+}
+
+bool QuizCache::contains(const QString &bookTitle)
+{
+    return QFile::exists(entryPath(bookTitle));
+}
+
+void QuizCache::store(const QString &bookTitle, const QList<QuizItem> &items)
+{
+    if (items.isEmpty() || !QDir().mkpath(m_dir)) {
+        return;
+    }
+
+    // Replaced atomically so a power-off never leaves a torn entry
+    QSaveFile file(entryPath(bookTitle));
+    QByteArray data = serialize(items);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "QuizCache: unable to write" << file.fileName();
+        return;
+    }
+
+    evict();
+}
+
+QByteArray QuizCache::serialize(const QList<QuizItem> &items)
+{
+    QJsonArray array;
+    for (const QuizItem &item : items) {
+        QJsonObject obj;
+        obj["question"] = item.question;
+        obj["options"] = QJsonArray::fromStringList(item.options);
+        obj["correct_answer"] = item.correctAnswer;
+        obj["explanation"] = item.explanation;
+        array.append(obj);
+    }
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
+QString QuizCache::entryPath(const QString &bookTitle)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(bookTitle.toUtf8());
+    hash.addData("\0", 1);
+    hash.addData(promptsHash());
+    hash.addData(QByteArray::number(m_quizLength));
+    return m_dir + "/" + QString::fromLatin1(hash.result().toHex()) + ".json";
+}
+
+QByteArray QuizCache::promptsHash()
+{
+    // Only rehash prompts.txt when it has been modified
+    QFileInfo info(PROMPTS_FILE_PATH);
+    QDateTime modified = info.lastModified();
+    if (m_promptsHash.isEmpty() || modified != m_promptsModified) {
+        QFile file(PROMPTS_FILE_PATH);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_promptsHash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+        } else {
+            m_promptsHash = QByteArray(1, '\0');
+        }
+        m_promptsModified = modified;
+    }
+    return m_promptsHash;
+}
+
+void QuizCache::evict()
+{
+    // Newest first, so everything past the limits is least recently used
+    QDir dir(m_dir);
+    QFileInfoList entries = dir.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Time);
+
+    qint64 totalBytes = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        totalBytes += entries.at(i).size();
+        if (i >= m_maxEntries || totalBytes > m_maxBytes) {
+            QFile::remove(entries.at(i).filePath());
+        }
+    }
+}
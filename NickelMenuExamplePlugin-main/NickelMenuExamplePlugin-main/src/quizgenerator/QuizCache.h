@@ -0,0 +1,45 @@
+#ifndef QUIZ_CACHE_H
+#define QUIZ_CACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+#include "QuizConfig.h"
+#include "QuizItem.h"
+
+const QString QUIZ_CACHE_DIR = ONBOARD_ROOT + "/.adds/quiz/cache";
+
+// Disk-backed cache of generated quizzes. Entries are keyed by book title,
+// quiz length and the contents of prompts.txt, so editing the prompts or
+// QUIZ_LENGTH invalidates them.
+// A file's mtime doubles as its last-use time for LRU eviction.
+class QuizCache
+{
+    public:
+        explicit QuizCache(const QString &dir = QUIZ_CACHE_DIR);
+
+        void setLimits(int maxEntries, qint64 maxBytes);
+        void setQuizLength(int count) { m_quizLength = count; }
+        bool lookup(const QString &bookTitle, QList<QuizItem> &items);
+        bool contains(const QString &bookTitle);
+        void store(const QString &bookTitle, const QList<QuizItem> &items);
+
+        static QByteArray serialize(const QList<QuizItem> &items);
+
+    private:
+        QString entryPath(const QString &bookTitle);
+        QByteArray promptsHash();
+        void evict();
+
+        QString m_dir;
+        int m_maxEntries = 200;
+        qint64 m_maxBytes = 2 * 1024 * 1024;
+        int m_quizLength = 3;
+
+        QByteArray m_promptsHash;
+        QDateTime m_promptsModified;
+};
+
+#endif // QUIZ_CACHE_H
@@ -0,0 +1,427 @@
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+#include "QuizClient.h"
+#include "QuizConfig.h"
+#include "QuizNetwork.h"
+
+static const char GENERATION_FAILED[] = "Failed to generate quiz questions. Check your internet connection and try again.";
+static const int SLOT_POLL_MS = 250;
+static const char GENERATION_TIMED_OUT[] = "Quiz generation timed out. Check your internet connection and try again.";
+
+// Failures worth retrying: network hiccups, rate limiting and server errors
+static bool isTransient(QNetworkReply *reply)
+{
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 429 || status >= 500) {
+        return true;
+    }
+
+    switch (reply->error()) {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+QuizClient::QuizClient(QObject *parent)
+    : QObject(parent)
+    , m_network(QuizNetwork::manager())
+    , m_prompts(PROMPTS_FILE_PATH)
+{
+    m_deadline.setSingleShot(true);
+    m_retryTimer.setSingleShot(true);
+    m_ticker.setInterval(1000);
+    connect(&m_deadline, &QTimer::timeout, this, &QuizClient::onDeadline);
+    connect(&m_retryTimer, &QTimer::timeout, this, &QuizClient::sendRequest);
+    connect(&m_ticker, &QTimer::timeout, this, &QuizClient::onTick);
+
+    qsrand(uint(QDateTime::currentMSecsSinceEpoch()) ^ uint(quintptr(this)));
+}
+
+void QuizClient::generate(const QuizRequest &request)
+{
+    cancel();
+    m_items.clear();
+
+    QuizConfig config = QuizConfig::load();
+    m_maxRetries = qBound(0, config.intValue("QUIZ_RETRIES", 2), 5);
+    m_attempt = 0;
+    m_parseNsecs = 0;
+    m_elapsed.start();
+    m_ticker.start();
+
+    QString backend = config.value("QUIZ_BACKEND");
+    m_backend.reset(backend == "script" ? nullptr : QuizBackend::create(backend, config));
+    if (m_backend) {
+        m_deadline.setInterval(m_backend->timeoutMs());
+        m_stallMs = m_backend->stallMs();
+        if (generateNative(request)) {
+            return;
+        }
+    }
+
+    m_backend.reset();
+    m_deadline.setInterval(qMax(5, config.intValue("QUIZ_SCRIPT_TIMEOUT_SECS", config.intValue("QUIZ_TIMEOUT_SECS", 90))) * 1000);
+    m_stallMs = qMax(0, config.intValue("QUIZ_STALL_SECS", 30)) * 1000LL;
+    generateWithScript(request);
+}
+
+bool QuizClient::renderPrompts(const QuizRequest &request, QString &systemPrompt, QString &userPrompt)
+{
+    if (!m_prompts.load()) {
+        return false;
+    }
+
+    QHash<QString, QString> values;
+    values.insert("book_title", request.bookTitle);
+    values.insert("author", request.author);
+    values.insert("count", QString::number(request.count));
+    values.insert("excerpt", request.excerpt);
+    values.insert("avoid", request.avoid.isEmpty() ? QString() : "- " + request.avoid.join("\n- "));
+    systemPrompt = m_prompts.system(values);
+    userPrompt = m_prompts.user(values);
+
+    // Prompts without a place for the excerpt or the avoid list get them at the end
+    if (!m_prompts.userHas("excerpt") && !request.excerpt.isEmpty()) {
+        userPrompt += "\n\nExcerpt from the book:\n" + request.excerpt;
+    }
+    if (!m_prompts.userHas("avoid") && !request.avoid.isEmpty()) {
+        userPrompt += "\n\nDo not repeat or reword these questions, which were asked before:\n"
+            + values.value("avoid");
+    }
+    return true;
+}
+
+bool QuizClient::generateNative(const QuizRequest &request)
+{
+    QString reason;
+    if (!m_backend->isUsable(&reason)) {
+        qWarning() << "QuizClient:" << m_backend->name() << "backend unusable," << reason << "- falling back to script";
+        return false;
+    }
+
+    QString systemPrompt, userPrompt;
+    if (!renderPrompts(request, systemPrompt, userPrompt)) {
+        qWarning() << "QuizClient: unable to read" << PROMPTS_FILE_PATH;
+        return false;
+    }
+
+    m_request = m_backend->request();
+    m_body = m_backend->body(systemPrompt, userPrompt);
+    sendRequest();
+    return true;
+}
+
+void QuizClient::cancel()
+{
+    finishRequest();
+    m_retryTimer.stop();
+
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+    if (m_process) {
+        m_process->disconnect(this);
+        m_process->kill();
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+void QuizClient::sendRequest()
+{
+    // Wait for another client to finish with the backend first
+    if (!m_backend->acquire()) {
+        m_retryTimer.start(SLOT_POLL_MS);
+        return;
+    }
+
+    // Retries only happen before any question was delivered, so start clean
+    ++m_attempt;
+    m_timedOut = false;
+    m_parser.reset();
+    m_eventBuffer.clear();
+    m_streaming = false;
+    m_firstByte = false;
+    m_lastActivity.start();
+    m_sent.start();
+
+    m_reply = m_network->post(m_request, m_body);
+    connect(m_reply, &QNetworkReply::readyRead, this, &QuizClient::onReplyReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &QuizClient::onReplyFinished);
+    m_deadline.start();
+}
+
+void QuizClient::onDeadline()
+{
+    m_timedOut = true;
+    if (m_reply) {
+        m_reply->abort();
+    } else if (m_process) {
+        m_process->kill();
+    }
+}
+
+void QuizClient::onTick()
+{
+    qint64 idle = (m_reply || m_process) ? m_lastActivity.elapsed() : 0;
+    emit progress(m_elapsed.elapsed(), idle, m_attempt);
+
+    // Data still trickling in means slow; silence means dead
+    if (m_stallMs > 0 && idle > m_stallMs) {
+        qWarning() << "QuizClient: no data for" << idle << "ms, giving up on attempt" << m_attempt;
+        onDeadline();
+    }
+}
+
+bool QuizClient::scheduleRetry()
+{
+    if (m_attempt > m_maxRetries) {
+        return false;
+    }
+
+    // 1s, 2s, 4s... scaled by a random factor in [0.5, 1.5)
+    int base = 1000 << qMin(m_attempt - 1, 4);
+    int delay = qMin(15000, base / 2 + qrand() % base);
+    qWarning() << "QuizClient: retrying in" << delay << "ms";
+    m_retryTimer.start(delay);
+    return true;
+}
+
+void QuizClient::finishRequest()
+{
+    m_deadline.stop();
+    m_ticker.stop();
+    if (m_backend) {
+        m_backend->release();
+    }
+}
+
+void QuizClient::onReplyReadyRead()
+{
+    m_lastActivity.restart();
+    if (!m_firstByte) {
+        m_firstByte = true;
+        if (m_timings) {
+            m_timings->record("first_byte", m_sent.nsecsElapsed() / 1000);
+        }
+    }
+
+    // A server that ignores "stream" is read in one piece when finished
+    if (!m_streaming) {
+        QString contentType = m_reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        if (!contentType.contains("text/event-stream")) {
+            return;
+        }
+        m_streaming = true;
+    }
+
+    m_eventBuffer.append(m_reply->readAll());
+    processEvents(false);
+}
+
+void QuizClient::onReplyFinished()
+{
+    m_deadline.stop();
+    m_backend->release();
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    if (m_timedOut || reply->error() != QNetworkReply::NoError) {
+        qWarning() << "QuizClient: attempt" << m_attempt << "failed:"
+                   << (m_timedOut ? QString("timed out") : reply->errorString());
+        if (m_items.isEmpty() && (m_timedOut || isTransient(reply)) && scheduleRetry()) {
+            return;
+        }
+        finishRequest();
+        emit quizFailed(m_timedOut ? GENERATION_TIMED_OUT : GENERATION_FAILED);
+        return;
+    }
+    finishRequest();
+
+    if (!m_streaming) {
+        QElapsedTimer parse;
+        parse.start();
+        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+        QJsonObject message = doc.object()["choices"].toArray().at(0).toObject()["message"].toObject();
+        m_parseNsecs += parse.nsecsElapsed();
+        emitParsed(message["content"].toString().toUtf8());
+        return;
+    }
+
+    m_eventBuffer.append(reply->readAll());
+    processEvents(true);
+    m_parser.finish();
+    recordParseTime();
+
+    if (m_items.isEmpty()) {
+        emit quizFailed(m_parser.failureMessage());
+    } else {
+        emit quizReady(m_items, m_parser.dropped());
+    }
+}
+
+// Decodes complete server-sent event lines and feeds their content deltas
+void QuizClient::processEvents(bool flush)
+{
+    // Event decoding and item parsing both count towards the parse stage;
+    // time spent in the slots connected to quizItemReady does not
+    QElapsedTimer parse;
+    parse.start();
+
+    if (flush && !m_eventBuffer.endsWith('\n')) {
+        m_eventBuffer.append('\n');
+    }
+
+    int newline;
+    while ((newline = m_eventBuffer.indexOf('\n')) >= 0) {
+        QByteArray line = m_eventBuffer.left(newline).trimmed();
+        m_eventBuffer.remove(0, newline + 1);
+
+        if (!line.startsWith("data:")) {
+            continue;
+        }
+        QByteArray payload = line.mid(5).trimmed();
+        if (payload == "[DONE]") {
+            continue;
+        }
+
+        QJsonDocument doc = QJsonDocument::fromJson(payload);
+        QJsonObject delta = doc.object()["choices"].toArray().at(0).toObject()["delta"].toObject();
+        QString content = delta["content"].toString();
+        if (!content.isEmpty()) {
+            QList<QuizItem> items = m_parser.feed(content.toUtf8());
+            if (items.isEmpty()) {
+                continue;
+            }
+
+            m_parseNsecs += parse.nsecsElapsed();
+            for (const QuizItem &item : items) {
+                m_items.append(item);
+                emit quizItemReady(item);
+            }
+            parse.restart();
+        }
+    }
+    m_parseNsecs += parse.nsecsElapsed();
+}
+
+void QuizClient::recordParseTime()
+{
+    if (m_timings) {
+        m_timings->record("parse", m_parseNsecs / 1000);
+    }
+    m_parseNsecs = 0;
+}
+
+void QuizClient::generateWithScript(const QuizRequest &request)
+{
+    QStringList arguments;
+    arguments << request.bookTitle;
+
+    QProcess *process = new QProcess(this);
+    m_process = process;
+    // The script sends the prompts as rendered here; it only reads
+    // prompts.txt itself when run by hand
+    QString systemPrompt, userPrompt;
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QUIZ_COUNT", QString::number(request.count));
+    if (renderPrompts(request, systemPrompt, userPrompt)) {
+        environment.insert("QUIZ_SYSTEM_PROMPT", systemPrompt);
+        environment.insert("QUIZ_USER_PROMPT", userPrompt);
+    }
+    process->setProcessEnvironment(environment);
+    m_timedOut = false;
+    m_attempt = 1;
+    m_lastActivity.start();
+
+    // Set up to capture output
+    process->setProcessChannelMode(QProcess::MergedChannels);
+
+    m_sent.start();
+    connect(process, &QProcess::started, this, [this]() {
+        if (m_timings) {
+            m_timings->record("spawn", m_sent.nsecsElapsed() / 1000);
+        }
+    });
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this]() {
+        m_lastActivity.restart();
+    });
+    connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
+        finishRequest();
+        m_process = nullptr;
+        if (m_timedOut) {
+            emit quizFailed(GENERATION_TIMED_OUT);
+        } else if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+            emitParsed(process->readAll());
+        } else {
+            emit quizFailed(GENERATION_FAILED);
+        }
+        process->deleteLater();
+    });
+    connect(process, static_cast<void(QProcess::*)(QProcess::ProcessError)>(&QProcess::error),
+            this, [this, process](QProcess::ProcessError error) {
+        // A process that never started will not emit finished
+        if (error == QProcess::FailedToStart && m_process == process) {
+            finishRequest();
+            m_process = nullptr;
+            emit quizFailed(GENERATION_FAILED);
+            process->deleteLater();
+        }
+    });
+
+    process->start(QUIZ_SCRIPT_PATH, arguments);
+    m_deadline.start();
+}
+
+void QuizClient::emitParsed(const QByteArray &content)
+{
+    QElapsedTimer parse;
+    parse.start();
+    QuizStreamParser parser;
+    QList<QuizItem> items = parser.feed(content);
+    parser.finish();
+    m_parseNsecs += parse.nsecsElapsed();
+    recordParseTime();
+
+    if (items.isEmpty()) {
+        emit quizFailed(parser.failureMessage());
+    } else {
+        m_items = items;
+        for (const QuizItem &item : items) {
+            emit quizItemReady(item);
+        }
+        emit quizReady(items, parser.dropped());
+    }
+}
+
+bool QuizClient::parseQuizItems(const QByteArray &data, QList<QuizItem> &items)
+{
+    QuizStreamParser parser;
+    items.append(parser.feed(data));
+    parser.finish();
+    return parser.foundArray();
+}
@@ -0,0 +1,118 @@
+#ifndef QUIZ_CLIENT_H
+#define QUIZ_CLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QtNetwork/QNetworkRequest>
+
+#include "PromptTemplate.h"
+#include "QuizBackend.h"
+#include "QuizConfig.h"
+#include "QuizItem.h"
+#include "QuizStreamParser.h"
+#include "QuizTimings.h"
+
+// What to ask for; only the title is required
+struct QuizRequest {
+    QString bookTitle;
+    QString author;
+    QString excerpt;     // A passage from the book to ground the questions in
+    QStringList avoid;   // Earlier questions the model should not repeat
+    int count = 3;       // Questions to ask for
+};
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QProcess;
+class QuizConfig;
+
+const QString QUIZ_SCRIPT_PATH = ONBOARD_ROOT + "/.adds/quiz/generateQuiz.sh";
+const QString PROMPTS_FILE_PATH = ONBOARD_ROOT + "/.adds/quiz/prompts.txt";
+
+// Generates quiz questions for a book. The chat-completions request is
+// sent from inside the plugin as a streamed completion, and each question
+// is delivered as soon as it has fully arrived. QUIZ_BACKEND picks the
+// service (see QuizBackend). generateQuiz.sh is only used when that
+// backend is unusable or QUIZ_BACKEND=script is set.
+//
+// Each attempt has the backend's deadline and is abandoned early if no
+// data arrives within its stall limit. Transient failures are retried
+// up to QUIZ_RETRIES times with jittered exponential backoff, as long as
+// no question has been delivered yet.
+class QuizClient : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit QuizClient(QObject *parent = nullptr);
+        void generate(const QuizRequest &request);
+        void cancel();
+
+        // Records spawn, first-byte and parse latencies when set
+        void setTimings(QuizTimings *timings) { m_timings = timings; }
+
+        // Parses a JSON array of questions out of a complete reply, keeping
+        // every well-formed question; see QuizStreamParser
+        static bool parseQuizItems(const QByteArray &data, QList<QuizItem> &items);
+
+    signals:
+        // Emitted for every question as it arrives, then quizReady once
+        // the whole quiz is in, with the questions the parser dropped.
+        // quizFailed may follow delivered questions.
+        void quizItemReady(const QuizItem &item);
+        void quizReady(const QList<QuizItem> &items, const QStringList &dropped);
+        void quizFailed(const QString &message);
+
+        // Emitted about once a second while a quiz is being generated
+        void progress(qint64 elapsedMs, qint64 idleMs, int attempt);
+
+    private:
+        bool renderPrompts(const QuizRequest &request, QString &systemPrompt, QString &userPrompt);
+        bool generateNative(const QuizRequest &request);
+        void generateWithScript(const QuizRequest &request);
+        void sendRequest();
+        void onReplyReadyRead();
+        void onReplyFinished();
+        void onDeadline();
+        void onTick();
+        bool scheduleRetry();
+        void finishRequest();
+        void processEvents(bool flush);
+        void recordParseTime();
+        void emitParsed(const QByteArray &content);
+
+        QNetworkAccessManager* m_network = nullptr;   // Shared, not owned
+        QScopedPointer<QuizBackend> m_backend;
+        QNetworkReply* m_reply = nullptr;
+        QProcess* m_process = nullptr;
+        PromptTemplate m_prompts;
+        QNetworkRequest m_request;
+        QByteArray m_body;
+
+        QTimer m_deadline;
+        QTimer m_ticker;
+        QTimer m_retryTimer;
+        QElapsedTimer m_elapsed;
+        QElapsedTimer m_lastActivity;
+        QElapsedTimer m_sent;
+        qint64 m_parseNsecs = 0;
+        bool m_firstByte = false;
+        QuizTimings* m_timings = nullptr;
+        qint64 m_stallMs = 0;
+        int m_attempt = 0;
+        int m_maxRetries = 0;
+        bool m_timedOut = false;
+
+        bool m_streaming = false;
+        QByteArray m_eventBuffer;
+        QuizStreamParser m_parser;
+        QList<QuizItem> m_items;
+};
+
+#endif // QUIZ_CLIENT_H
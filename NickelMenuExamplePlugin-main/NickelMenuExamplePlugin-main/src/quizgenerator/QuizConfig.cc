@@ -0,0 +1,72 @@
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "QuizConfig.h"
+
+QuizConfig QuizConfig::load(const QString &path)
+{
+    static QString cachedPath;
+    static QDateTime cachedModified;
+    static qint64 cachedSize = -1;
+    static QuizConfig cached;
+
+    QFileInfo info(path);
+    qint64 size = info.exists() ? info.size() : -1;
+    if (path == cachedPath && info.lastModified() == cachedModified && size == cachedSize) {
+        return cached;
+    }
+
+    cached = parse(path);
+    cachedPath = path;
+    cachedModified = info.lastModified();
+    cachedSize = size;
+    return cached;
+}
+
+QuizConfig QuizConfig::parse(const QString &path)
+{
+    QuizConfig config;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return config;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        if (line.startsWith("export ")) {
+            line = line.mid(7).trimmed();
+        }
+
+        int eq = line.indexOf('=');
+        if (eq <= 0) {
+            continue;
+        }
+        QString key = line.left(eq).trimmed();
+        QString val = line.mid(eq + 1).trimmed();
+
+        // Strip matching shell quotes
+        if (val.size() >= 2 && (val.startsWith('"') || val.startsWith('\'')) && val.endsWith(val.at(0))) {
+            val = val.mid(1, val.size() - 2);
+        }
+        config.m_values.insert(key, val);
+    }
+    return config;
+}
+
+QString QuizConfig::value(const QString &key, const QString &defaultValue) const
+{
+    return m_values.value(key, defaultValue);
+}
+
+int QuizConfig::intValue(const QString &key, int defaultValue) const
+{
+    bool ok = false;
+    int result = m_values.value(key).toInt(&ok);
+    return ok ? result : defaultValue;
+}
@@ -0,0 +1,34 @@
+#ifndef QUIZ_CONFIG_H
+#define QUIZ_CONFIG_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+// The device's user storage. Setting QUIZ_ONBOARD_ROOT in the process
+// environment moves every path below it, so the plugin can run off the device.
+const QString ONBOARD_ROOT = qgetenv("QUIZ_ONBOARD_ROOT").isEmpty()
+    ? QString("/mnt/onboard") : QString::fromLocal8Bit(qgetenv("QUIZ_ONBOARD_ROOT"));
+
+const QString ENV_FILE_PATH = ONBOARD_ROOT + "/.adds/pkm/.env";
+const QString BOOKS_LIST_PATH = ONBOARD_ROOT + "/.adds/quiz/books.json";
+
+// Key/value settings read from the shared .env file. The file is a
+// shell fragment, so only simple `KEY=value` lines are understood.
+// load() is called for every action, so the parsed file is kept and only
+// read again when its mtime or size changes. Only used on the UI thread.
+class QuizConfig
+{
+    public:
+        static QuizConfig load(const QString &path = ENV_FILE_PATH);
+
+        QString value(const QString &key, const QString &defaultValue = QString()) const;
+        int intValue(const QString &key, int defaultValue) const;
+
+    private:
+        static QuizConfig parse(const QString &path);
+
+        QHash<QString, QString> m_values;
+};
+
+#endif // QUIZ_CONFIG_H
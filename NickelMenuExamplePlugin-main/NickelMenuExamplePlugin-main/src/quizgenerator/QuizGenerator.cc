@@ -11,46 +11,25 @@
 #include <QJsonArray>
 #include <QDebug>
 #include <QEvent>
-#include <QMouseEvent>
 #include <QApplication>
-#include <QListWidget>
+#include <QListView>
 #include <QProcess>
 #include <QSizePolicy>
+#include <QStackedWidget>
 #include <QTimer>
 
+#include "BookChunks.h"
+#include "QuizBackend.h"
+#include "QuizNetwork.h"
+#include "QuizConfig.h"
 #include "QuizGenerator.h"
+#include "QuizTheme.h"
 
 void QuizGenerator::showError(const QString& message) 
 {
-    clearCurrentLayout();
-    QVBoxLayout* layout = new QVBoxLayout(&m_dlg);
-    
-    m_errorLabel = new QLabel(message, &m_dlg);
-    m_errorLabel->setStyleSheet(
-        "QLabel {"
-        "    font-size: 32px;"
-        "    margin: 10px;"
-        "    padding: 5px;"
-        "}"
-    );
-    m_errorLabel->setWordWrap(true);
-    m_errorLabel->setAlignment(Qt::AlignCenter);
-    layout->addWidget(m_errorLabel);
-
-    m_errorButton = new QPushButton("OK", &m_dlg);
-    m_errorButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    margin: 10px;"
-        "    min-width: 150px;"
-        "}"
-    );
-    layout->addWidget(m_errorButton, 0, Qt::AlignCenter);
-    connect(m_errorButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
-
-    m_dlg.setLayout(layout);
-    m_dlg.showDlg();
+    ensureUi();
+    m_errorLabel->setText(message);
+    showPage(m_errorPage);
 }
 
 QuizGenerator::QuizGenerator() 
@@ -58,8 +37,51 @@ QuizGenerator::QuizGenerator()
     , m_score(0)
     , m_uiInitialized(false)
 {
-    // Constructor now just initializes member variables
-    // No need to load questions here since they're generated on demand
+    // Questions are generated on demand by the quiz client
+    m_quizClient = new QuizClient(this);
+    connect(m_quizClient, &QuizClient::quizItemReady, this, &QuizGenerator::onQuizItemReady);
+    connect(m_quizClient, &QuizClient::quizReady, this, &QuizGenerator::onQuizReady);
+    connect(m_quizClient, &QuizClient::quizFailed, this, &QuizGenerator::onQuizFailed);
+    connect(m_quizClient, &QuizClient::progress, this, &QuizGenerator::onQuizProgress);
+
+    QuizConfig config = QuizConfig::load();
+    m_bookModel = new BookListModel(&m_catalogue, this);
+
+    m_seen.setThreshold(config.intValue("QUIZ_DUPLICATE_SIMILARITY", 60));
+
+    m_quizCache.setLimits(config.intValue("QUIZ_CACHE_MAX_ENTRIES", 200),
+                          config.intValue("QUIZ_CACHE_MAX_KB", 2048) * 1024LL);
+
+    // Background prefetching yields to quizzes the user is waiting on
+    m_prefetcher = new QuizPrefetcher(&m_quizCache, this);
+    m_prefetcher->setConcurrency(config.intValue("QUIZ_PREFETCH_CONCURRENCY", 1));
+    m_prefetcher->setDelay(config.intValue("QUIZ_PREFETCH_DELAY_MS", 1000));
+    m_prefetcher->setQuizLength(qBound(1, config.intValue("QUIZ_LENGTH", 3), 50));
+    m_quizCache.setQuizLength(qBound(1, config.intValue("QUIZ_LENGTH", 3), 50));
+
+    m_bookSync = new BookListSync(this);
+    connect(m_bookSync, &BookListSync::finished, this, &QuizGenerator::onServerImportFinished);
+
+    m_libraryImport = new LibraryImportJob(this);
+    connect(m_libraryImport, &LibraryImportJob::finished, this, &QuizGenerator::onLibraryImportFinished);
+
+    m_extractor = new BookExtractor(this);
+    connect(m_extractor, &BookExtractor::finished, this, &QuizGenerator::onBookExtracted);
+    m_extractionWait.setSingleShot(true);
+    connect(&m_extractionWait, &QTimer::timeout, this, &QuizGenerator::onExtractionWaitOver);
+
+    // Latency samples reach the disk once per visit rather than per stage
+    m_quizClient->setTimings(&m_timings);
+    connect(&m_dlg, &QDialog::finished, this, [this](int) {
+        stopGenerating();
+        recordAnswers();
+        m_timings.flush();
+    });
+
+    connect(&m_dlg, &NPDialog::swiped, this, &QuizGenerator::onSwiped);
+
+    m_repaintTrace = new RepaintTrace(&m_dlg, this);
+    m_repaintTrace->setEnabled(config.value("QUIZ_REPAINT_TRACE") == "1");
 }
 
 void QuizGenerator::showUi()
@@ -75,12 +97,17 @@ void QuizGenerator::showUi()
 
 void QuizGenerator::updateQuestion()
 {
+    QuizTimings::Span span(&m_timings, "question");
+
     // Guard against out-of-range
     if (m_currentIndex < 0 || m_currentIndex >= m_quizData.size()) {
         showFinalScore();
         return;
     }
 
+    m_repaintTrace->beginTransition();
+    m_questionTimer.start();
+
     // Set question text
     m_questionLabel->setText(m_quizData[m_currentIndex].question);
 
@@ -90,36 +117,22 @@ void QuizGenerator::updateQuestion()
     m_buttonGroup->setExclusive(false);
     for (auto btn : m_optionButtons) {
         btn->setChecked(false);
+        btn->setEnabled(true);
     }
     m_buttonGroup->setExclusive(true);
 
     // Update the option widgets
-    QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-    if (!mainLayout) return;
-
-    // Skip the question label (index 0)
-    for (int i = 0; i < 4; i++) {
-        int layoutIndex = i + 1; // +1 to skip question label
-        if (layoutIndex >= mainLayout->count()) break;
-
-        QLayoutItem* item = mainLayout->itemAt(layoutIndex);
-        QWidget* optionWidget = item ? item->widget() : nullptr;
-        if (!optionWidget) continue;
-
-        // Get the label from the option widget's layout
-        if (QHBoxLayout* optLayout = qobject_cast<QHBoxLayout*>(optionWidget->layout())) {
-            if (optLayout->count() >= 2) { // Should have radio button and label
-                if (QLabel* label = qobject_cast<QLabel*>(optLayout->itemAt(1)->widget())) {
-                    if (i < options.size()) {
-                        label->setText(options.at(i));
-                        optionWidget->show();
-                    } else {
-                        optionWidget->hide();
-                    }
-                }
-            }
+    for (int i = 0; i < m_optionWidgets.size(); i++) {
+        if (i < options.size()) {
+            m_optionLabels.at(i)->setText(options.at(i));
+            setStyleState(m_optionLabels.at(i), "state", QString());
+            m_optionWidgets.at(i)->show();
+        } else {
+            m_optionWidgets.at(i)->hide();
         }
     }
+
+    m_repaintTrace->endTransition("question");
 }
 
 void QuizGenerator::onSubmitClicked()
@@ -129,6 +142,8 @@ void QuizGenerator::onSubmitClicked()
         return;
     }
 
+    m_answerMs.append(qint32(m_questionTimer.elapsed()));
+
     // Check the selected answer
     int selectedId = m_buttonGroup->checkedId();
     QString chosen;
@@ -145,123 +160,134 @@ void QuizGenerator::onSubmitClicked()
         m_userAnswers.append(QString());
     }
 
+    // Rescheduled now, so an abandoned quiz still counts
+    m_bank.recordAnswer(m_sessionIds.value(m_currentIndex, -1),
+                        chosen == m_quizData[m_currentIndex].correctAnswer);
+
     // Move to next question or finish
     m_currentIndex++;
     if (m_currentIndex < m_quizData.size()) {
         updateQuestion();
+    } else if (m_generating) {
+        showWaitingForQuestion();
     } else {
         showFinalScore();
     }
 }
 
+void QuizGenerator::showWaitingForQuestion()
+{
+    m_waitingForQuestion = true;
+    m_repaintTrace->beginTransition();
+    m_questionLabel->setText("Loading the next question...");
+    m_submitButton->setEnabled(false);
+
+    // Hide the option widgets until the question arrives
+    for (QWidget *optionWidget : m_optionWidgets) {
+        optionWidget->hide();
+    }
+    m_repaintTrace->endTransition("waiting");
+}
+
 void QuizGenerator::showFinalScore()
 {
+    QuizTimings::Span span(&m_timings, "score");
+    m_waitingForQuestion = false;
+    recordAnswers();
+    m_quizMode = QuizMode::Score;
+    m_repaintTrace->beginTransition();
+
     // Hide all option widgets first
-    QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-    if (mainLayout) {
-        for (int i = 0; i < mainLayout->count(); i++) {
-            QLayoutItem* item = mainLayout->itemAt(i);
-            if (QWidget* widget = item->widget()) {
-                if (widget != m_questionLabel) {  // Don't hide the question label
-                    widget->hide();
-                }
-            }
-        }
+    for (QWidget *optionWidget : m_optionWidgets) {
+        optionWidget->hide();
     }
+    m_explanationLabel->hide();
 
-    m_questionLabel->setText(
-        QString("Quiz finished!\nYou scored %1/%2.")
-            .arg(m_score)
-            .arg(m_quizData.size())
-    );
-
-    // Create a new horizontal layout for the final buttons
-    m_buttonLayout = new QHBoxLayout();
+    QString text = QString("Quiz finished!\nYou scored %1/%2.")
+        .arg(m_score)
+        .arg(m_quizData.size());
+    if (m_droppedCount > 0) {
+        text += QString("\n%1 malformed question(s) were skipped.").arg(m_droppedCount);
+    }
+    m_questionLabel->setText(text);
 
-    // "Review" button
+    // "Review" and "Close" buttons
     m_submitButton->setText("Review");
-    m_submitButton->show();  // Make sure it's visible
-    connect(m_submitButton, &QPushButton::clicked, this, &QuizGenerator::onReviewClicked);
-    m_buttonLayout->addWidget(m_submitButton);
+    m_submitButton->setEnabled(true);
+    m_secondaryButton->show();
+    m_repaintTrace->endTransition("score");
+}
 
-    // "Close" button
-    if (!m_secondaryButton) {
-        m_secondaryButton = new QPushButton("Close", &m_dlg);
-        m_secondaryButton->setStyleSheet(
-            "QPushButton {"
-            "    font-size: 28px;"
-            "    padding: 10px;"
-            "    margin: 10px;"
-            "    min-width: 150px;"
-            "}"
-        );
-        // Add touch event handling
-        m_secondaryButton->setAttribute(Qt::WA_AcceptTouchEvents);
-        m_secondaryButton->installEventFilter(&m_dlg);
+// The session goes into the history once, when the score is shown or the
+// dialog is closed part way; only the questions answered so far count
+void QuizGenerator::recordAnswers()
+{
+    if (m_answersRecorded || m_userAnswers.isEmpty()) {
+        return;
     }
-    
-    // Always reconnect the close signal (in case it was disconnected)
-    m_secondaryButton->disconnect();
-    connect(m_secondaryButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
-    m_buttonLayout->addWidget(m_secondaryButton);
+    m_answersRecorded = true;
+
+    QuizSession session;
+    session.started = m_sessionStarted;
+    session.durationMs = m_sessionTimer.elapsed();
+    session.book = m_currentBook;
+    session.items = m_quizData.mid(0, m_userAnswers.size());
+    session.answers = m_userAnswers;
+    session.answerMs = m_answerMs;
+    m_history.append(session);
+}
 
-    // Add button layout to main layout
-    mainLayout->addLayout(m_buttonLayout);
+// Questions enter the bank as they arrive, unanswered and due today, so
+// one that is shown but never answered still comes back for review
+void QuizGenerator::bankNewQuestions()
+{
+    for (int i = m_sessionIds.size(); i < m_quizData.size(); ++i) {
+        m_sessionIds.append(m_bank.add(m_currentBook, m_quizData.at(i)));
+    }
 }
 
-// Add this method to handle touch events for radio buttons
+void QuizGenerator::onPrimaryClicked()
+{
+    switch (m_quizMode) {
+        case QuizMode::Answering:
+            onSubmitClicked();
+            break;
+        case QuizMode::Score:
+            onReviewClicked();
+            break;
+        case QuizMode::Review:
+            onReviewNextClicked();
+            break;
+    }
+}
+
+// Touches arrive here as mouse events synthesized by NPDialog
 bool QuizGenerator::eventFilter(QObject *obj, QEvent *event)
 {
-    // Handle button touch events
-    if (QPushButton *button = qobject_cast<QPushButton*>(obj)) {
-        if (event->type() == QEvent::TouchBegin ||
-            event->type() == QEvent::TouchEnd) {
-            
-            QMouseEvent *mouseEvent = new QMouseEvent(
-                event->type() == QEvent::TouchBegin ? QEvent::MouseButtonPress : QEvent::MouseButtonRelease,
-                button->mapFromGlobal(QCursor::pos()),
-                Qt::LeftButton,
-                Qt::LeftButton,
-                Qt::NoModifier
-            );
-            
-            QApplication::postEvent(button, mouseEvent);
-            return true;
-        }
+    if (obj == m_questionLabel && event->type() == QEvent::Paint && m_firstPaintPending) {
+        m_firstPaintPending = false;
+        m_timings.record("tap_to_paint", m_tapTimer.nsecsElapsed() / 1000);
     }
 
-    // Handle radio button touch events
-    if (QRadioButton *radio = qobject_cast<QRadioButton*>(obj)) {
-        if (event->type() == QEvent::TouchBegin ||
-            event->type() == QEvent::TouchEnd) {
-            
-            QMouseEvent *mouseEvent = new QMouseEvent(
-                event->type() == QEvent::TouchBegin ? QEvent::MouseButtonPress : QEvent::MouseButtonRelease,
-                radio->mapFromGlobal(QCursor::pos()),
-                Qt::LeftButton,
-                Qt::LeftButton,
-                Qt::NoModifier
-            );
-            
-            QApplication::postEvent(radio, mouseEvent);
-            return true;
+    // Hidden stats screen
+    if (obj == m_titleLabel && event->type() == QEvent::MouseButtonRelease) {
+        if (!m_titleTaps.isValid() || m_titleTaps.elapsed() > 3000) {
+            m_titleTaps.start();
+            m_titleTapCount = 0;
         }
+        if (++m_titleTapCount >= 5) {
+            m_titleTaps.invalidate();
+            showStats();
+        }
+        return true;
     }
-    
-    // Handle label clicks
-    if (QLabel *label = qobject_cast<QLabel*>(obj)) {
-        if (event->type() == QEvent::MouseButtonRelease) {
-            // Find the associated radio button (sibling in the layout)
-            if (QWidget* parentWidget = label->parentWidget()) {
-                if (QHBoxLayout* layout = qobject_cast<QHBoxLayout*>(parentWidget->layout())) {
-                    if (layout->count() >= 1) {
-                        if (QRadioButton* radio = qobject_cast<QRadioButton*>(layout->itemAt(0)->widget())) {
-                            radio->setChecked(true);
-                            return true;
-                        }
-                    }
-                }
-            }
+
+    // Clicking an option label selects its radio button
+    if (event->type() == QEvent::MouseButtonRelease) {
+        int option = m_optionLabels.indexOf(qobject_cast<QLabel*>(obj));
+        if (option >= 0 && m_optionButtons.at(option)->isEnabled()) {
+            m_optionButtons.at(option)->setChecked(true);
+            return true;
         }
     }
 
@@ -271,31 +297,11 @@ bool QuizGenerator::eventFilter(QObject *obj, QEvent *event)
 void QuizGenerator::onReviewClicked()
 {
     m_currentIndex = 0;
+    m_quizMode = QuizMode::Review;
 
     // Set button text
     m_submitButton->setText(m_quizData.size() > 1 ? "Next" : "Close");
-    m_submitButton->disconnect();
-    connect(m_submitButton, &QPushButton::clicked, this, &QuizGenerator::onReviewNextClicked);
-
-    // Make sure the close button is properly connected
-    if (m_secondaryButton) {
-        m_secondaryButton->disconnect();
-        connect(m_secondaryButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
-        m_secondaryButton->show();
-    }
-
-    // Show all option widgets
-    QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-    if (mainLayout) {
-        for (int i = 0; i < mainLayout->count(); i++) {
-            QLayoutItem* item = mainLayout->itemAt(i);
-            if (QWidget* widget = item->widget()) {
-                if (widget != m_questionLabel && widget != m_submitButton) {
-                    widget->show();
-                }
-            }
-        }
-    }
+    m_secondaryButton->setVisible(m_quizData.size() > 1);
 
     updateReviewQuestion();
 }
@@ -307,6 +313,8 @@ void QuizGenerator::updateReviewQuestion()
         return;
     }
 
+    m_repaintTrace->beginTransition();
+
     // Set question text
     m_questionLabel->setText(m_quizData[m_currentIndex].question);
 
@@ -315,66 +323,30 @@ void QuizGenerator::updateReviewQuestion()
     QString correctAnswer = m_quizData[m_currentIndex].correctAnswer;
 
     // Update each option widget
-    QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-    if (!mainLayout) return;
-
-    // Skip the question label (index 0)
-    for (int i = 0; i < 4; i++) {
-        int layoutIndex = i + 1; // +1 to skip question label
-        if (layoutIndex >= mainLayout->count()) break;
-
-        QLayoutItem* item = mainLayout->itemAt(layoutIndex);
-        QWidget* optionWidget = item ? item->widget() : nullptr;
-        if (!optionWidget) continue;
-
-        // Get the radio button and label from the option widget's layout
-        if (QHBoxLayout* optLayout = qobject_cast<QHBoxLayout*>(optionWidget->layout())) {
-            if (optLayout->count() >= 2) {
-                QRadioButton* radio = qobject_cast<QRadioButton*>(optLayout->itemAt(0)->widget());
-                QLabel* label = qobject_cast<QLabel*>(optLayout->itemAt(1)->widget());
-                
-                if (radio && label && i < options.size()) {
-                    // Set the text
-                    label->setText(options.at(i));
-                    
-                    // Set checked state
-                    radio->setChecked(options.at(i) == userAnswer);
-                    
-                    // Highlight correct/incorrect answers
-                    QString color = "black";
-                    if (options.at(i) == correctAnswer) {
-                        color = "green";
-                    } else if (options.at(i) == userAnswer && userAnswer != correctAnswer) {
-                        color = "red";
-                    }
-                    
-                    label->setStyleSheet(QString("QLabel { color: %1; }").arg(color));
-                    radio->setEnabled(false);
-                    optionWidget->show();
-                } else {
-                    optionWidget->hide();
-                }
+    for (int i = 0; i < m_optionWidgets.size(); i++) {
+        QRadioButton* radio = m_optionButtons.at(i);
+        QLabel* label = m_optionLabels.at(i);
+
+        if (i < options.size()) {
+            // Set the text
+            label->setText(options.at(i));
+
+            // Set checked state
+            radio->setChecked(options.at(i) == userAnswer);
+
+            // Highlight correct/incorrect answers
+            QString state;
+            if (options.at(i) == correctAnswer) {
+                state = "correct";
+            } else if (options.at(i) == userAnswer && userAnswer != correctAnswer) {
+                state = "wrong";
             }
-        }
-    }
 
-    // Add explanation box
-    if (!m_explanationLabel) {
-        m_explanationLabel = new QLabel(&m_dlg);
-        m_explanationLabel->setWordWrap(true);
-        m_explanationLabel->setStyleSheet(
-            "QLabel {"
-            "    font-size: 28px;"
-            "    padding: 15px;"
-            "    margin: 10px;"
-            "    background-color: #f5f5f5;"
-            "    border: 2px solid #e0e0e0;"
-            "    border-radius: 10px;"
-            "}"
-        );
-        QVBoxLayout* mainLayout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-        if (mainLayout) {
-            mainLayout->addWidget(m_explanationLabel);
+            setStyleState(label, "state", state);
+            radio->setEnabled(false);
+            m_optionWidgets.at(i)->show();
+        } else {
+            m_optionWidgets.at(i)->hide();
         }
     }
 
@@ -382,6 +354,8 @@ void QuizGenerator::updateReviewQuestion()
     QString explanation = m_quizData[m_currentIndex].explanation;
     m_explanationLabel->setText("Explanation: " + explanation);
     m_explanationLabel->show();
+
+    m_repaintTrace->endTransition("review");
 }
 
 void QuizGenerator::onReviewNextClicked()
@@ -389,14 +363,10 @@ void QuizGenerator::onReviewNextClicked()
     m_currentIndex++;
     if (m_currentIndex < m_quizData.size()) {
         if (m_currentIndex == m_quizData.size() - 1) {
+            // The next click past the last question closes the dialog
             m_submitButton->setText("Close");
-            // Disconnect the "next" connection and connect to close instead
-            m_submitButton->disconnect();
-            connect(m_submitButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
             // Hide the secondary close button when we're showing the last question
-            if (m_secondaryButton) {
-                m_secondaryButton->hide();
-            }
+            m_secondaryButton->hide();
         }
         updateReviewQuestion();
     } else {
@@ -404,412 +374,786 @@ void QuizGenerator::onReviewNextClicked()
     }
 }
 
+void QuizGenerator::onReviewPreviousClicked()
+{
+    if (m_currentIndex <= 0) {
+        return;
+    }
+
+    m_currentIndex--;
+    m_submitButton->setText("Next");
+    m_secondaryButton->show();
+    updateReviewQuestion();
+}
+
+// Swipes page the book list and the quiz like the buttons do
+void QuizGenerator::onSwiped(NPDialog::SwipeDirection direction)
+{
+    QWidget *page = m_stack ? m_stack->currentWidget() : nullptr;
+
+    if (page == m_selectionPage && m_bookListView->isEnabled()) {
+        if (direction == NPDialog::SwipeUp) {
+            handleBookScrollDown();
+        } else if (direction == NPDialog::SwipeDown) {
+            handleBookScrollUp();
+        }
+    } else if (page == m_quizPage) {
+        if (direction == NPDialog::SwipeLeft) {
+            if (m_quizMode == QuizMode::Answering && m_submitButton->isEnabled()) {
+                onSubmitClicked();
+            } else if (m_quizMode == QuizMode::Review) {
+                onReviewNextClicked();
+            }
+        } else if (direction == NPDialog::SwipeRight && m_quizMode == QuizMode::Review) {
+            onReviewPreviousClicked();
+        }
+    }
+}
+
 void QuizGenerator::handleBookScrollUp()
 {
-    if (!m_bookListWidget || m_bookListWidget->count() == 0) return;
-    
-    int currentRow = m_bookListWidget->currentRow();
+    if (!m_bookListView || m_bookModel->totalCount() == 0) return;
+
+    int currentRow = m_bookListView->currentIndex().row();
     if (currentRow == -1) {
-        currentRow = m_bookListWidget->count() - 1;  // Start from bottom if no selection
+        currentRow = m_bookModel->rowCount() - 1;  // Start from the last loaded row if no selection
     }
-    
+
     // Move up 5 items or to top
     int newRow = qMax(0, currentRow - 5);
-    m_bookListWidget->setCurrentRow(newRow);
-    m_bookListWidget->scrollToItem(m_bookListWidget->currentItem(), QAbstractItemView::PositionAtCenter);
+    QModelIndex index = m_bookModel->index(newRow);
+    m_bookListView->setCurrentIndex(index);
+    m_bookListView->scrollTo(index, QAbstractItemView::PositionAtCenter);
 }
 
 void QuizGenerator::handleBookScrollDown()
 {
-    if (!m_bookListWidget || m_bookListWidget->count() == 0) return;
-    
-    int currentRow = m_bookListWidget->currentRow();
+    if (!m_bookListView || m_bookModel->totalCount() == 0) return;
+
+    int currentRow = m_bookListView->currentIndex().row();
     if (currentRow == -1) {
         currentRow = 0;  // Start from top if no selection
     }
-    
-    // Move down 5 items or to bottom
-    int newRow = qMin(m_bookListWidget->count() - 1, currentRow + 5);
-    m_bookListWidget->setCurrentRow(newRow);
-    m_bookListWidget->scrollToItem(m_bookListWidget->currentItem(), QAbstractItemView::PositionAtCenter);
+
+    // Move down 5 items or to bottom, loading the next page if needed
+    int newRow = qMin(m_bookModel->totalCount() - 1, currentRow + 5);
+    m_bookModel->ensureFetched(newRow);
+    QModelIndex index = m_bookModel->index(newRow);
+    m_bookListView->setCurrentIndex(index);
+    m_bookListView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void QuizGenerator::applyBookFilter(const QString &text)
+{
+    m_bookModel->setFilter(text);
 }
 
 void QuizGenerator::showBookSelection()
 {
-    clearCurrentLayout();
-    QVBoxLayout *layout = new QVBoxLayout(&m_dlg);
+    QuizTimings::Span span(&m_timings, "selection");
+    ensureUi();
+
+    // Back from a quiz or a cancelled request
+    m_loadingLabel->hide();
+    m_cancelButton->hide();
+    m_bookListView->setEnabled(true);
+
+    // Picks up books added or read since the last visit in the background;
+    // the list below is reloaded if it changed. The very first import has
+    // no list to show yet, so its progress is shown as for the Import button.
+    bool firstImport = false;
+    if (usesLibraryImport()) {
+        firstImport = !QFile::exists(BOOKS_LIST_PATH);
+        m_libraryImportShown = m_libraryImportShown || firstImport;
+        m_libraryImport->start();
+    }
 
-    // Create top bar with title and import button
-    QHBoxLayout* topBar = new QHBoxLayout();
+    QString error;
+    if (!firstImport && !m_catalogue.load(&error)) {
+        showError(error);
+        return;
+    }
+    m_bookModel->setFilter(m_filterEdit->text());
 
-    // Title label
-    QLabel *label = new QLabel("Select a book to generate quiz:", &m_dlg);
-    label->setStyleSheet(
-        "QLabel {"
-        "    font-size: 38px;"
-        "    margin: 10px;"
-        "    padding: 5px;"
-        "}"
-    );
-    topBar->addWidget(label);
+    int due = m_bank.dueCount();
+    m_reviewDueButton->setText(QString("Review due (%1)").arg(due));
+    m_reviewDueButton->setEnabled(due > 0);
 
-    // Add import button
-    QPushButton* importButton = new QPushButton("Import", &m_dlg);
-    importButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 10px 20px;"
-        "    background-color: #000000;"
-        "    border: none;"
-        "    border-radius: 10px;"
-        "    color: #ffffff;"
-        "    min-width: 100px;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #333333;"
-        "}"
-    );
-    importButton->setAttribute(Qt::WA_AcceptTouchEvents);
-    importButton->installEventFilter(this);
-    connect(importButton, &QPushButton::clicked, this, &QuizGenerator::runImportScript);
-    topBar->addWidget(importButton);
+    // Use the Wi-Fi connection brought up for the menu entry to fill the cache
+    if (QuizConfig::load().value("QUIZ_PREFETCH") == "1") {
+        m_prefetcher->start(m_catalogue.titles());
+    }
 
-    layout->addLayout(topBar);
+    showPage(m_selectionPage);
+    if (firstImport) {
+        showStatusMessage("Reading the library...");
+    }
+    preconnect();
+}
 
-    // Add status label
-    m_statusLabel = new QLabel(&m_dlg);
-    m_statusLabel->setStyleSheet(
-        "QLabel {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    border-radius: 5px;"
-        "}"
-    );
-    m_statusLabel->setAlignment(Qt::AlignCenter);
-    m_statusLabel->hide();  // Hidden by default
-    layout->addWidget(m_statusLabel);
+// The handshake happens while the user picks a book, not after the tap
+void QuizGenerator::preconnect()
+{
+    QuizConfig config = QuizConfig::load();
+    QString backend = config.value("QUIZ_BACKEND");
+    if (backend != "script" && backend != "cloze") {
+        QScopedPointer<QuizBackend> service(QuizBackend::create(backend, config));
+        QString reason;
+        if (service && service->isUsable(&reason)) {
+            QuizNetwork::preconnect(service->url());
+        }
+    }
+    if (!usesLibraryImport()) {
+        QuizNetwork::preconnect(BookListSync::endpoint());
+    }
+}
 
-    m_bookListWidget = new QListWidget(&m_dlg);
-    m_bookListWidget->setStyleSheet(
-        "QListWidget {"
-        "    font-size: 32px;"
-        "    margin: 10px;"
-        "}"
-    );
-
-    QFile file(BOOKS_LIST_PATH);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Unable to open books.json";
-        showError("Unable to open books list file.");
+void QuizGenerator::onReviewDueClicked()
+{
+    stopGenerating();
+    QList<int> ids = m_bank.dueQuestions(qMax(1, QuizConfig::load().intValue("QUIZ_REVIEW_SIZE", 10)));
+
+    m_quizData.clear();
+    m_sessionIds.clear();
+    for (int id : ids) {
+        QuizItem item;
+        if (m_bank.question(id, &item)) {
+            m_quizData.append(item);
+            m_sessionIds.append(id);
+        }
+    }
+    if (m_quizData.isEmpty()) {
+        showStatusMessage("No questions are due for review.");
         return;
     }
-    QByteArray data = file.readAll();
-    file.close();
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject()) {
-        qWarning() << "Invalid books JSON format!";
-        showError("Invalid books list format.");
+    m_currentBook.clear();
+    m_waitingForQuestion = false;
+    m_droppedCount = 0;
+    m_quizShown = true;
+    showQuizUi();
+}
+
+void QuizGenerator::onBookSelected()
+{
+    startQuiz(false);
+}
+
+void QuizGenerator::onFreshQuizSelected()
+{
+    startQuiz(true);
+}
+
+void QuizGenerator::startQuiz(bool bypassCache)
+{
+    QString bookTitle = m_bookModel->titleAt(m_bookListView->currentIndex().row());
+    if (bookTitle.isEmpty()) {
+        showError("Please select a book.");
         return;
     }
 
-    QJsonArray bookArray = doc.object()["books"].toArray();
-    QStringList bookTitles;
-    for (const QJsonValue &val : bookArray) {
-        bookTitles.append(val.toString());
+    stopGenerating();
+    m_currentBook = bookTitle;
+    m_sessionIds.clear();
+    m_quizShown = false;
+    m_waitingForQuestion = false;
+    m_duplicates.clear();
+    m_droppedCount = 0;
+
+    // One spare batch replaces questions dropped as repeats
+    QuizConfig config = QuizConfig::load();
+    m_quizLength = qBound(1, config.intValue("QUIZ_LENGTH", 3), 50);
+    m_batchSize = qBound(1, config.intValue("QUIZ_BATCH_SIZE", 3), m_quizLength);
+    m_batchesLeft = (m_quizLength + m_batchSize - 1) / m_batchSize + 1;
+    m_quizCache.setQuizLength(m_quizLength);
+    m_prefetcher->setQuizLength(m_quizLength);
+
+    // Measured up to the first paint of the question
+    m_tapTimer.start();
+    m_firstPaintPending = true;
+
+    // A cached quiz opens straight away without touching the network
+    QList<QuizItem> cached;
+    if (!bypassCache && m_quizCache.lookup(bookTitle, cached)) {
+        m_generating = false;
+        m_quizData = cached;
+        m_quizShown = true;
+        for (const QuizItem &item : cached) {
+            m_seen.remember(bookTitle, item);
+        }
+        showQuizUi();
+        return;
+    }
+    m_generating = true;
+
+    // Show loading indicator and disable the list while loading
+    m_loadingLabel->setText("Generating quiz questions...");
+    m_loadingLabel->show();
+    m_cancelButton->show();
+    m_bookListView->setEnabled(false);
+
+    // The first quiz for a book waits a few seconds for its text; a slow
+    // extraction still finishes in the background for the next quiz
+    QString path = m_catalogue.path(m_catalogue.indexOf(bookTitle));
+    if (!path.isEmpty() && config.intValue("QUIZ_EXCERPT_CHARS", 3000) > 0
+            && config.value("QUIZ_BACKEND") != "cloze" && !BookChunks::isCached(path)) {
+        m_loadingLabel->setText("Reading the book...");
+        m_extractingPath = path;
+        m_extractor->extract(path);
+        m_extractionWait.start(qMax(0, config.intValue("QUIZ_EXTRACT_WAIT_MS", 5000)));
+        return;
     }
 
-    m_bookListWidget->addItems(bookTitles);
-    layout->addWidget(m_bookListWidget);
-
-    // Create button container
-    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    // Generate quiz for the selected book
+    generateQuizForBook(bookTitle);
+}
 
-    // Create a select button
-    QPushButton *selectButton = new QPushButton("Select", &m_dlg);
-    selectButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    margin: 10px;"
-        "    min-width: 150px;"
-        "}"
-    );
-    buttonLayout->addWidget(selectButton);
+void QuizGenerator::onBookExtracted(const QString &bookPath, bool ok)
+{
+    Q_UNUSED(ok);
+    if (m_extractionWait.isActive() && bookPath == m_extractingPath) {
+        m_extractionWait.stop();
+        onExtractionWaitOver();
+    }
+}
 
-    // Create scroll buttons
-    m_bookScrollUpButton = new QPushButton("▲", &m_dlg);
-    m_bookScrollUpButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 15px;"
-        "    background-color: #000000;"
-        "    border: none;"
-        "    border-radius: 10px;"
-        "    color: #ffffff;"
-        "    min-width: 60px;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #333333;"
-        "}"
-    );
-    m_bookScrollUpButton->setAttribute(Qt::WA_AcceptTouchEvents);
-    m_bookScrollUpButton->installEventFilter(this);
-    connect(m_bookScrollUpButton, &QPushButton::clicked, this, &QuizGenerator::handleBookScrollUp);
-    buttonLayout->addWidget(m_bookScrollUpButton);
+void QuizGenerator::onExtractionWaitOver()
+{
+    m_extractingPath.clear();
+    m_loadingLabel->setText("Generating quiz questions...");
+    generateQuizForBook(m_currentBook);
+}
 
-    m_bookScrollDownButton = new QPushButton("▼", &m_dlg);
-    m_bookScrollDownButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 15px;"
-        "    background-color: #000000;"
-        "    border: none;"
-        "    border-radius: 10px;"
-        "    color: #ffffff;"
-        "    min-width: 60px;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #333333;"
-        "}"
-    );
-    m_bookScrollDownButton->setAttribute(Qt::WA_AcceptTouchEvents);
-    m_bookScrollDownButton->installEventFilter(this);
-    connect(m_bookScrollDownButton, &QPushButton::clicked, this, &QuizGenerator::handleBookScrollDown);
-    buttonLayout->addWidget(m_bookScrollDownButton);
+void QuizGenerator::generateQuizForBook(const QString &bookTitle)
+{
+    m_generateTimer.start();
+    if (QuizConfig::load().value("QUIZ_BACKEND") == "cloze") {
+        QString error;
+        if (!startOfflineQuiz(bookTitle, &error)) {
+            m_generating = false;
+            showError(error);
+        }
+        return;
+    }
 
-    // Create exit button
-    QPushButton *exitButton = new QPushButton("Exit", &m_dlg);
-    exitButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    margin: 10px;"
-        "    min-width: 150px;"
-        "}"
-    );
-    buttonLayout->addWidget(exitButton);
+    // A passage from the book, when its text has been extracted, and the
+    // latest questions already asked about it
+    QuizConfig config = QuizConfig::load();
+    QuizRequest request;
+    request.bookTitle = bookTitle;
+    int index = m_catalogue.indexOf(bookTitle);
+    request.author = m_catalogue.author(index);
+    QString path = m_catalogue.path(index);
+    if (!path.isEmpty()) {
+        request.excerpt = BookChunks::excerpt(path, config.intValue("QUIZ_EXCERPT_CHARS", 3000));
+    }
+    request.avoid = m_seen.recent(bookTitle, qMax(0, config.intValue("QUIZ_AVOID_RECENT", 10)));
+    int accepted = m_quizShown ? m_quizData.size() : 0;
+    request.count = qMax(1, qMin(m_batchSize, m_quizLength - accepted));
+    --m_batchesLeft;
 
-    // Add button layout to main layout
-    layout->addLayout(buttonLayout);
+    m_prefetcher->pause();
+    m_quizClient->generate(request);
+}
 
-    connect(selectButton, &QPushButton::clicked, this, &QuizGenerator::onBookSelected);
-    connect(exitButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
+// Fill-in-the-blank questions from the book file itself, no network needed
+bool QuizGenerator::startOfflineQuiz(const QString &bookTitle, QString *error)
+{
+    QString path = m_catalogue.path(m_catalogue.indexOf(bookTitle));
+    if (path.isEmpty()) {
+        if (error) *error = "This book has no local file to build a quiz from.";
+        return false;
+    }
 
-    // Set the layout
-    m_dlg.setLayout(layout);
+    QList<QuizItem> items;
+    {
+        QuizTimings::Span span(&m_timings, "cloze");
+        items = ClozeGenerator::generate(path, qMax(1, QuizConfig::load().intValue("QUIZ_CLOZE_QUESTIONS", 5)), error);
+    }
+    if (items.isEmpty()) {
+        return false;
+    }
 
-    // Show the dialog
-    m_dlg.showDlg();
+    m_generating = false;
+    m_quizData = items;
+    m_quizShown = true;
+    showQuizUi();
+    return true;
 }
 
-void QuizGenerator::onBookSelected()
+void QuizGenerator::onQuizProgress(qint64 elapsedMs, qint64 idleMs, int attempt)
 {
-    QListWidgetItem *selectedItem = m_bookListWidget->currentItem();
-    if (!selectedItem) {
-        showError("Please select a book.");
+    if (!m_loadingLabel) {
         return;
     }
 
-    QString bookTitle = selectedItem->text();
+    QString text = QString("Generating quiz questions... %1s").arg(elapsedMs / 1000);
+    if (attempt > 1) {
+        text += QString(" (attempt %1)").arg(attempt);
+    }
+    if (idleMs >= 10000) {
+        text += QString("\nNo response for %1s").arg(idleMs / 1000);
+    }
+    m_loadingLabel->setText(text);
+}
+
+void QuizGenerator::onCancelClicked()
+{
+    stopGenerating();
+    showBookSelection();
+}
 
-    // Show loading indicator
-    QLabel* loadingLabel = new QLabel("Generating quiz questions...", &m_dlg);
-    loadingLabel->setStyleSheet(
-        "QLabel {"
-        "    font-size: 32px;"
-        "    margin: 10px;"
-        "    padding: 5px;"
-        "}"
-    );
-    loadingLabel->setAlignment(Qt::AlignCenter);
+// Drops the batches still due for the previous quiz, so they cannot land
+// in the next one
+void QuizGenerator::stopGenerating()
+{
+    m_extractionWait.stop();
+    m_extractingPath.clear();
+    m_quizClient->cancel();
+    m_generating = false;
+    m_batchesLeft = 0;
+    m_prefetcher->resume();
+}
 
-    // Disable the list and button while loading
-    m_bookListWidget->setEnabled(false);
-    m_bookListWidget->setStyleSheet(
-        "QListWidget {"
-        "    font-size: 32px;"
-        "    margin: 10px;"
-        "    color: gray;"
-        "}"
-    );
+void QuizGenerator::onQuizItemReady(const QuizItem &item)
+{
+    // The spare batch can overshoot the quiz length
+    if (m_quizShown && m_quizData.size() >= m_quizLength) {
+        return;
+    }
+    if (!m_seen.remember(m_currentBook, item)) {
+        m_duplicates.append(item);
+        return;
+    }
 
-    // Add loading label to the layout
-    QVBoxLayout* layout = qobject_cast<QVBoxLayout*>(m_dlg.layout());
-    if (layout) {
-        layout->addWidget(loadingLabel);
+    // The quiz opens on the first question while the rest stream in
+    if (!m_quizShown) {
+        m_timings.record("first_question", m_generateTimer.nsecsElapsed() / 1000);
+        m_quizShown = true;
+        m_quizData.clear();
+        m_quizData.append(item);
+        showQuizUi();
+        return;
     }
 
-    // Generate quiz for the selected book
-    generateQuizForBook(bookTitle);
+    m_quizData.append(item);
+    bankNewQuestions();
+    if (m_waitingForQuestion) {
+        m_waitingForQuestion = false;
+        m_submitButton->setEnabled(true);
+        updateQuestion();
+    }
 }
 
-void QuizGenerator::generateQuizForBook(const QString &bookTitle)
+void QuizGenerator::onQuizReady(const QList<QuizItem> &items, const QStringList &dropped)
 {
-    QString scriptPath = QUIZ_SCRIPT_PATH;
-    QStringList arguments;
-    arguments << bookTitle;
+    Q_UNUSED(items);
+    m_droppedCount += dropped.size();
+    m_timings.record("generate", m_generateTimer.nsecsElapsed() / 1000);
+
+    // The next batch is on its way before the user reaches the end of this
+    // one; questions just accepted are already in its avoid list
+    int accepted = m_quizShown ? m_quizData.size() : 0;
+    if (accepted < m_quizLength && m_batchesLeft > 0) {
+        generateQuizForBook(m_currentBook);
+        return;
+    }
 
-    QProcess *process = new QProcess(this);
-    
-    // Set up to capture output
-    process->setProcessChannelMode(QProcess::MergedChannels);
-    
-    connect(process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-            [=](int exitCode, QProcess::ExitStatus /*exitStatus*/){
-        if (exitCode == 0) {
-            // Read the output directly from the process
-            QByteArray output = process->readAll();
-            
-            // Parse the JSON from the output
-            QJsonDocument doc = QJsonDocument::fromJson(output);
-            if (doc.isArray()) {
-                QList<QuizItem> newQuizData;
-                QJsonArray arr = doc.array();
-                
-                for (auto val : arr) {
-                    QJsonObject obj = val.toObject();
-                    QuizItem item;
-                    item.question = obj["question"].toString();
-                    
-                    QJsonArray optionsArray = obj["options"].toArray();
-                    QStringList options;
-                    for (const QJsonValue &option : optionsArray) {
-                        options.append(option.toString());
-                    }
-                    item.options = options;
-                    
-                    item.correctAnswer = obj["correct_answer"].toString();
-                    item.explanation = obj["explanation"].toString();
-                    newQuizData.push_back(item);
-                }
-                
-                if (!newQuizData.isEmpty()) {
-                    m_quizData = newQuizData;
-                    showQuizUi();
-                } else {
-                    showError("No questions were generated.");
-                }
-            } else {
-                showError("Invalid quiz format generated.");
-            }
+    m_generating = false;
+    m_prefetcher->resume();
+    if (!m_quizShown) {
+        if (m_duplicates.isEmpty()) {
+            onQuizFailed("No questions were generated.");
         } else {
-            showError("Failed to generate quiz questions. Check your internet connection and try again.");
+            showRepeatedQuestions();
         }
-        process->deleteLater();
-    });
+        return;
+    }
+    m_quizCache.store(m_currentBook, m_quizData);
+    if (m_waitingForQuestion) {
+        showFinalScore();
+    }
+}
+
+void QuizGenerator::onQuizFailed(const QString &message)
+{
+    m_generating = false;
+    m_prefetcher->resume();
+    if (!m_quizShown && !m_duplicates.isEmpty()) {
+        showRepeatedQuestions();
+        return;
+    }
+    if (!m_quizShown) {
+        // Offline, or the service is down: fall back to the book's own text
+        QString offlineError;
+        if (!startOfflineQuiz(m_currentBook, &offlineError)) {
+            showError(message);
+        }
+        return;
+    }
+
+    // Finish with the questions that did arrive
+    qWarning() << "Quiz generation stopped early:" << message;
+    if (m_waitingForQuestion) {
+        showFinalScore();
+    }
+}
 
-    process->start(scriptPath, arguments);
+// Better a repeated quiz than none when nothing new came back
+void QuizGenerator::showRepeatedQuestions()
+{
+    m_generating = false;
+    m_prefetcher->resume();
+    m_quizData = m_duplicates;
+    m_duplicates.clear();
+    m_quizShown = true;
+    showQuizUi();
 }
 
 void QuizGenerator::showQuizUi()
 {
-    // Clear existing layout and widgets properly
-    clearCurrentLayout();
+    QuizTimings::Span span(&m_timings, "quiz_ui");
+    ensureUi();
+
+    m_currentIndex = 0;
+    m_score = 0;
+    m_userAnswers.clear();
+    m_answersRecorded = false;
+    bankNewQuestions();
+    m_quizMode = QuizMode::Answering;
+    m_answerMs.clear();
+    m_sessionStarted = QDateTime::currentDateTime();
+    m_sessionTimer.start();
+
+    m_submitButton->setText("Submit");
+    m_submitButton->setEnabled(true);
+    m_secondaryButton->hide();
+    m_explanationLabel->hide();
+
+    // Load the first question
+    updateQuestion();
+
+    showPage(m_quizPage);
+}
+
+void QuizGenerator::showPage(QWidget *page)
+{
+    m_stack->setCurrentWidget(page);
+    if (!m_dlg.isVisible()) {
+        m_dlg.showDlg();
+    }
+}
+
+// Builds every screen once; later transitions only switch pages
+void QuizGenerator::ensureUi()
+{
+    if (m_uiInitialized) {
+        return;
+    }
+
+    // One stylesheet for every screen; states switch through properties
+    m_dlg.setStyleSheet(QUIZ_THEME);
 
-    // Create new layout
     QVBoxLayout *layout = new QVBoxLayout(&m_dlg);
+    layout->setContentsMargins(0, 0, 0, 0);
+    m_stack = new QStackedWidget(&m_dlg);
+    layout->addWidget(m_stack);
+
+    m_selectionPage = buildSelectionPage();
+    m_quizPage = buildQuizPage();
+    m_errorPage = buildErrorPage();
+    m_statsPage = buildStatsPage();
+    m_historyPage = buildHistoryPage();
+    m_stack->addWidget(m_selectionPage);
+    m_stack->addWidget(m_quizPage);
+    m_stack->addWidget(m_errorPage);
+    m_stack->addWidget(m_statsPage);
+    m_stack->addWidget(m_historyPage);
+    m_repaintTrace->watch();
+
+    m_uiInitialized = true;
+}
+
+QWidget* QuizGenerator::buildSelectionPage()
+{
+    QWidget *page = new QWidget(m_stack);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    // Create top bar with title and import button
+    QHBoxLayout* topBar = new QHBoxLayout();
+
+    // Title label
+    m_titleLabel = new QLabel("Select a book to generate quiz:", page);
+    m_titleLabel->setObjectName("titleLabel");
+    // Tapping the title five times opens the timing stats
+    m_titleLabel->installEventFilter(this);
+    topBar->addWidget(m_titleLabel);
+
+    // Add import button
+    QPushButton* importButton = new QPushButton("Import", page);
+    importButton->setObjectName("importButton");
+    connect(importButton, &QPushButton::clicked, this, &QuizGenerator::runImport);
+    topBar->addWidget(importButton);
+
+    // Offline session over questions the bank has scheduled for today
+    m_reviewDueButton = new QPushButton("Review due", page);
+    m_reviewDueButton->setObjectName("reviewDueButton");
+    connect(m_reviewDueButton, &QPushButton::clicked, this, &QuizGenerator::onReviewDueClicked);
+    topBar->addWidget(m_reviewDueButton);
+
+    QPushButton* historyButton = new QPushButton("History", page);
+    historyButton->setObjectName("historyButton");
+    connect(historyButton, &QPushButton::clicked, this, &QuizGenerator::showHistory);
+    topBar->addWidget(historyButton);
+
+    layout->addLayout(topBar);
+
+    // Add status label
+    m_statusLabel = new QLabel(page);
+    m_statusLabel->setObjectName("statusLabel");
+    m_statusLabel->setAlignment(Qt::AlignCenter);
+    m_statusLabel->hide();  // Hidden by default
+    layout->addWidget(m_statusLabel);
+
+    // Type-ahead filter over the catalogue
+    m_filterEdit = new QLineEdit(page);
+    m_filterEdit->setPlaceholderText("Filter books...");
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &QuizGenerator::applyBookFilter);
+    layout->addWidget(m_filterEdit);
+
+    m_bookListView = new QListView(page);
+    m_bookListView->setUniformItemSizes(true);
+    m_bookListView->setModel(m_bookModel);
+    layout->addWidget(m_bookListView);
+
+    // Loading indicator, shown while a quiz is being generated
+    m_loadingLabel = new QLabel(page);
+    m_loadingLabel->setObjectName("loadingLabel");
+    m_loadingLabel->setAlignment(Qt::AlignCenter);
+    m_loadingLabel->hide();
+    layout->addWidget(m_loadingLabel);
+
+    // Let the user abandon a slow or stuck request
+    m_cancelButton = new QPushButton("Cancel", page);
+    m_cancelButton->hide();
+    connect(m_cancelButton, &QPushButton::clicked, this, &QuizGenerator::onCancelClicked);
+    layout->addWidget(m_cancelButton, 0, Qt::AlignCenter);
+
+    // Create button container
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    // Create a select button
+    QPushButton *selectButton = new QPushButton("Select", page);
+    buttonLayout->addWidget(selectButton);
+
+    // Create a button that skips the cache and asks for new questions
+    QPushButton *freshButton = new QPushButton("Fresh", page);
+    buttonLayout->addWidget(freshButton);
+
+    // Create scroll buttons
+    m_bookScrollUpButton = new QPushButton("▲", page);
+    m_bookScrollUpButton->setProperty("role", "scroll");
+    connect(m_bookScrollUpButton, &QPushButton::clicked, this, &QuizGenerator::handleBookScrollUp);
+    buttonLayout->addWidget(m_bookScrollUpButton);
+
+    m_bookScrollDownButton = new QPushButton("▼", page);
+    m_bookScrollDownButton->setProperty("role", "scroll");
+    connect(m_bookScrollDownButton, &QPushButton::clicked, this, &QuizGenerator::handleBookScrollDown);
+    buttonLayout->addWidget(m_bookScrollDownButton);
+
+    // Create exit button
+    QPushButton *exitButton = new QPushButton("Exit", page);
+    buttonLayout->addWidget(exitButton);
+
+    // Add button layout to main layout
+    layout->addLayout(buttonLayout);
+
+    connect(selectButton, &QPushButton::clicked, this, &QuizGenerator::onBookSelected);
+    connect(freshButton, &QPushButton::clicked, this, &QuizGenerator::onFreshQuizSelected);
+    connect(exitButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
+
+    return page;
+}
+
+QWidget* QuizGenerator::buildQuizPage()
+{
+    QWidget *page = new QWidget(m_stack);
+    QVBoxLayout *layout = new QVBoxLayout(page);
     layout->setSpacing(10);
     layout->setContentsMargins(20, 20, 20, 20);
 
     // Create question label
-    m_questionLabel = new QLabel(&m_dlg);
+    m_questionLabel = new QLabel(page);
     m_questionLabel->setWordWrap(true);
-    m_questionLabel->setStyleSheet(
-        "QLabel {"
-        "    font-size: 55px;"
-        "    margin: 10px;"
-        "    padding: 5px;"
-        "}"
-    );
+    m_questionLabel->setObjectName("questionLabel");
+    m_questionLabel->installEventFilter(this);
     layout->addWidget(m_questionLabel);
 
     // Create radio button group
-    m_buttonGroup = new QButtonGroup(&m_dlg);
+    m_buttonGroup = new QButtonGroup(page);
     m_buttonGroup->setExclusive(true);
 
-    m_optionButtons.clear(); // Clear previous buttons if any
-
     // Create option widgets (radio button + label pairs)
     for (int i = 0; i < 4; i++) {
-        QWidget* optionWidget = createOptionWidget(i, "");
+        QWidget* optionWidget = createOptionWidget(page, i);
+        m_optionWidgets.append(optionWidget);
         layout->addWidget(optionWidget);
     }
 
+    // Explanation box, only shown during review
+    m_explanationLabel = new QLabel(page);
+    m_explanationLabel->setWordWrap(true);
+    m_explanationLabel->setObjectName("explanationLabel");
+    m_explanationLabel->hide();
+    layout->addWidget(m_explanationLabel);
+
+    // Spare room collects above the buttons, so a longer question only moves
+    // the widgets below it instead of re-spacing the whole page
     layout->addSpacing(20);
+    layout->addStretch();
 
-    // Submit button
-    m_submitButton = new QPushButton("Submit", &m_dlg);
-    m_submitButton->setStyleSheet(
-        "QPushButton {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    margin: 10px;"
-        "    min-width: 150px;"
-        "}"
-    );
-    layout->addWidget(m_submitButton, 0, Qt::AlignCenter);
-    connect(m_submitButton, &QPushButton::clicked, this, &QuizGenerator::onSubmitClicked);
-
-    // Set the new layout (don't delete old one, clearCurrentLayout already did that)
-    m_dlg.setLayout(layout);
+    // Submit button, which becomes "Review", "Next" and "Close" later on
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
 
-    // Load the first question
-    updateQuestion();
+    m_submitButton = new QPushButton("Submit", page);
+    connect(m_submitButton, &QPushButton::clicked, this, &QuizGenerator::onPrimaryClicked);
+    buttonLayout->addWidget(m_submitButton);
 
-    // Show the dialog
-    m_dlg.showDlg();
+    // "Close" button
+    m_secondaryButton = new QPushButton("Close", page);
+    m_secondaryButton->hide();
+    connect(m_secondaryButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
+    buttonLayout->addWidget(m_secondaryButton);
+
+    buttonLayout->addStretch();
+    layout->addLayout(buttonLayout);
+
+    return page;
 }
 
-void QuizGenerator::clearCurrentLayout()
+QWidget* QuizGenerator::buildErrorPage()
 {
-    // Disconnect all signals
-    if (m_submitButton) {
-        m_submitButton->disconnect();
+    QWidget *page = new QWidget(m_stack);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    m_errorLabel = new QLabel(page);
+    m_errorLabel->setObjectName("errorLabel");
+    m_errorLabel->setWordWrap(true);
+    m_errorLabel->setAlignment(Qt::AlignCenter);
+    layout->addWidget(m_errorLabel);
+
+    m_errorButton = new QPushButton("OK", page);
+    layout->addWidget(m_errorButton, 0, Qt::AlignCenter);
+    connect(m_errorButton, &QPushButton::clicked, &m_dlg, &QDialog::reject);
+
+    return page;
+}
+
+QWidget* QuizGenerator::buildStatsPage()
+{
+    QWidget *page = new QWidget(m_stack);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    m_statsLabel = new QLabel(page);
+    m_statsLabel->setObjectName("statsLabel");
+    m_statsLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    layout->addWidget(m_statsLabel, 1);
+
+    QPushButton *backButton = new QPushButton("Back", page);
+    layout->addWidget(backButton, 0, Qt::AlignCenter);
+    connect(backButton, &QPushButton::clicked, this, [this]() {
+        showPage(m_selectionPage);
+    });
+
+    return page;
+}
+
+void QuizGenerator::showStats()
+{
+    QString text = QString("%1 %2 %3 %4\n")
+        .arg("stage", -16).arg("n", 6).arg("p50 ms", 10).arg("p95 ms", 10);
+    for (const QuizTimings::Stats &stats : m_timings.stats()) {
+        text += QString("%1 %2 %3 %4\n")
+            .arg(stats.stage, -16)
+            .arg(stats.count, 6)
+            .arg(stats.p50 / 1000.0, 10, 'f', 1)
+            .arg(stats.p95 / 1000.0, 10, 'f', 1);
     }
-    
-    if (QLayout* layout = m_dlg.layout()) {
-        // First, handle any nested layouts
-        for (int i = 0; i < layout->count(); ++i) {
-            QLayoutItem* item = layout->itemAt(i);
-            if (QLayout* childLayout = item->layout()) {
-                while (QLayoutItem* childItem = childLayout->takeAt(0)) {
-                    if (QWidget* widget = childItem->widget()) {
-                        widget->hide();
-                        widget->deleteLater();
-                    }
-                    delete childItem;
-                }
-            }
-        }
-        
-        // Then handle the main layout
-        while (QLayoutItem* item = layout->takeAt(0)) {
-            if (QWidget* widget = item->widget()) {
-                widget->hide();
-                widget->deleteLater();
-            }
-            delete item;
-        }
-        delete layout;
+    m_statsLabel->setText(text);
+    showPage(m_statsPage);
+}
+
+QWidget* QuizGenerator::buildHistoryPage()
+{
+    QWidget *page = new QWidget(m_stack);
+    QVBoxLayout *layout = new QVBoxLayout(page);
+
+    m_historyLabel = new QLabel(page);
+    m_historyLabel->setObjectName("historyLabel");
+    m_historyLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    m_historyLabel->setWordWrap(true);
+    layout->addWidget(m_historyLabel, 1);
+
+    QPushButton *backButton = new QPushButton("Back", page);
+    layout->addWidget(backButton, 0, Qt::AlignCenter);
+    connect(backButton, &QPushButton::clicked, this, [this]() {
+        showPage(m_selectionPage);
+    });
+
+    return page;
+}
+
+// Reads only the summary, however many sessions the log holds
+void QuizGenerator::showHistory()
+{
+    QList<QuizHistory::BookStats> books = m_history.books();
+    if (books.isEmpty()) {
+        m_historyLabel->setText("No quizzes finished yet.");
+        showPage(m_historyPage);
+        return;
     }
 
-    // Reset all pointers
-    m_questionLabel = nullptr;
-    m_buttonGroup = nullptr;
-    m_submitButton = nullptr;
-    m_secondaryButton = nullptr;
-    m_buttonLayout = nullptr;
-    m_bookListWidget = nullptr;
-    m_optionButtons.clear();
-    m_explanationLabel = nullptr;
+    int questions = 0, correct = 0;
+    for (const QuizHistory::BookStats &stats : books) {
+        questions += stats.questions;
+        correct += stats.correct;
+    }
+    QString text = QString("%1 quizzes, %2% of %3 answers correct\n\n")
+        .arg(m_history.sessionCount())
+        .arg(questions > 0 ? correct * 100 / questions : 0)
+        .arg(questions);
+
+    for (int i = 0; i < books.size() && i < 12; ++i) {
+        const QuizHistory::BookStats &stats = books.at(i);
+        text += QString("%1\n    %2 quizzes, %3% correct, best %4%, last %5\n")
+            .arg(stats.book.isEmpty() ? QString("Review due") : stats.book)
+            .arg(stats.sessions)
+            .arg(stats.questions > 0 ? stats.correct * 100 / stats.questions : 0)
+            .arg(stats.bestPercent)
+            .arg(QDateTime::fromMSecsSinceEpoch(stats.lastPlayed).date().toString(Qt::ISODate));
+    }
+
+    text += "\nRecent:\n";
+    QList<QuizHistory::Entry> recent = m_history.recent();
+    for (int i = 0; i < recent.size() && i < 8; ++i) {
+        const QuizHistory::Entry &entry = recent.at(i);
+        text += QString("%1  %2/%3  %4\n")
+            .arg(QDateTime::fromMSecsSinceEpoch(entry.started).toString("yyyy-MM-dd hh:mm"))
+            .arg(entry.score)
+            .arg(entry.total)
+            .arg(entry.book.isEmpty() ? QString("Review due") : entry.book);
+    }
+
+    m_historyLabel->setText(text);
+    showPage(m_historyPage);
 }
 
 // Create a custom widget for each option
-QWidget* QuizGenerator::createOptionWidget(int index, const QString &text)
+QWidget* QuizGenerator::createOptionWidget(QWidget *parent, int index)
 {
     // A container widget to hold radio button + label
-    QWidget *optionWidget = new QWidget(&m_dlg);
+    QWidget *optionWidget = new QWidget(parent);
     optionWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
 
     QHBoxLayout *optionLayout = new QHBoxLayout(optionWidget);
@@ -819,7 +1163,6 @@ QWidget* QuizGenerator::createOptionWidget(int index, const QString &text)
     // Create the radio button
     QRadioButton *radio = new QRadioButton(optionWidget);
     radio->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-    radio->installEventFilter(this);
     // Add to button group
     m_buttonGroup->addButton(radio, index);
     m_optionButtons.append(radio);
@@ -828,25 +1171,95 @@ QWidget* QuizGenerator::createOptionWidget(int index, const QString &text)
 
     // Create a wrapping label for the text
     QLabel *optionLabel = new QLabel(optionWidget);
-    optionLabel->setText(text);
     optionLabel->setWordWrap(true); // Will wrap for long text
     optionLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
-    optionLabel->setStyleSheet(
-        "QLabel {"
-        "    font-size: 38px;"
-        "    margin: 5px;"
-        "    padding: 5px;"
-        "}"
-    );
+    optionLabel->setProperty("role", "option");
 
     // Let the user click the label to toggle the radio button
     optionLabel->installEventFilter(this);
+    m_optionLabels.append(optionLabel);
 
     optionLayout->addWidget(optionLabel);
 
     return optionWidget;
 }
 
+bool QuizGenerator::usesLibraryImport() const
+{
+    return QuizConfig::load().value("QUIZ_BOOKS_SOURCE", "server") == "library";
+}
+
+void QuizGenerator::runImport()
+{
+    if (usesLibraryImport()) {
+        runLibraryImport();
+    } else if (BookListSync::endpoint().isValid()) {
+        runServerImport();
+    } else {
+        runImportScript();
+    }
+}
+
+void QuizGenerator::runLibraryImport()
+{
+    showStatusMessage("Updating book list...");
+    m_libraryImportShown = true;
+    m_libraryImport->start();
+}
+
+void QuizGenerator::onLibraryImportFinished(bool ok, bool changed, const QString &error)
+{
+    bool shown = m_libraryImportShown;
+    m_libraryImportShown = false;
+    if (!ok) {
+        qWarning() << "Library import failed:" << error;
+        if (shown) {
+            showStatusMessage("Error: " + error, true);
+        }
+        return;
+    }
+
+    if (changed) {
+        QString loadError;
+        if (!m_catalogue.load(&loadError)) {
+            if (shown) {
+                showStatusMessage("Error: " + loadError, true);
+            }
+            return;
+        }
+        m_bookModel->reload();
+    }
+    if (shown) {
+        showStatusMessage("Book list updated successfully!", false);
+    }
+}
+
+void QuizGenerator::runServerImport()
+{
+    showStatusMessage("Updating book list...");
+    m_bookSync->start(QuizConfig::load().intValue("QUIZ_IMPORT_TIMEOUT_SECS", 60));
+}
+
+void QuizGenerator::onServerImportFinished(bool ok, bool changed, const QString &error)
+{
+    if (!ok) {
+        showStatusMessage("Update failed: " + error, true);
+        return;
+    }
+    if (!changed) {
+        showStatusMessage("Book list is up to date.", false);
+        return;
+    }
+
+    QString loadError;
+    if (m_catalogue.load(&loadError)) {
+        m_bookModel->reload();
+        showStatusMessage("Book list updated successfully!", false);
+    } else {
+        showStatusMessage("Error: " + loadError, true);
+    }
+}
+
 void QuizGenerator::runImportScript()
 {
     showStatusMessage("Updating book list...");
@@ -856,33 +1269,25 @@ void QuizGenerator::runImportScript()
             [this, process](int exitCode, QProcess::ExitStatus) {
         if (exitCode == 0) {
             // Reload the book list widget with new data
-            QFile file(BOOKS_LIST_PATH);
-            if (file.open(QIODevice::ReadOnly)) {
-                QByteArray data = file.readAll();
-                file.close();
-
-                QJsonDocument doc = QJsonDocument::fromJson(data);
-                if (doc.isObject()) {
-                    m_bookListWidget->clear();  // Clear existing items
-                    QJsonArray bookArray = doc.object()["books"].toArray();
-                    QStringList bookTitles;
-                    for (const QJsonValue &val : bookArray) {
-                        bookTitles.append(val.toString());
-                    }
-                    m_bookListWidget->addItems(bookTitles);
-                    showStatusMessage("Book list updated successfully!", false);
-                } else {
-                    showStatusMessage("Error: Invalid books list format", true);
-                }
+            QString error;
+            if (m_catalogue.load(&error)) {
+                m_bookModel->reload();
+                showStatusMessage("Book list updated successfully!", false);
             } else {
-                showStatusMessage("Error: Could not read books list", true);
+                showStatusMessage("Error: " + error, true);
             }
         } else {
             showStatusMessage("Update failed. Check your connection.", true);
         }
         process->deleteLater();
     });
-    
+
+    // Kill an import that hangs on a dead connection
+    QTimer* deadline = new QTimer(process);
+    deadline->setSingleShot(true);
+    connect(deadline, &QTimer::timeout, process, &QProcess::kill);
+    deadline->start(qMax(5, QuizConfig::load().intValue("QUIZ_IMPORT_TIMEOUT_SECS", 60)) * 1000);
+
     process->start(UPDATE_BOOKS_SCRIPT_PATH);
 }
 
@@ -893,16 +1298,7 @@ void QuizGenerator::showStatusMessage(const QString& message, bool isError)
     }
 
     m_statusLabel->setText(message);
-    m_statusLabel->setStyleSheet(
-        QString("QLabel {"
-        "    font-size: 28px;"
-        "    padding: 10px;"
-        "    border-radius: 5px;"
-        "    background-color: %1;"
-        "    color: %2;"
-        "}").arg(isError ? "#ffebee" : "#e8f5e9",  // Light red or light green background
-                isError ? "#c62828" : "#2e7d32")    // Dark red or dark green text
-    );
+    setStyleState(m_statusLabel, "state", isError ? "error" : "ok");
     m_statusLabel->show();
 
     // Auto-hide after 3 seconds
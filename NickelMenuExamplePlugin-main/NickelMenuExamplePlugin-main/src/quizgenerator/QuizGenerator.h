@@ -8,23 +8,36 @@
 #include <QStringList>
 #include <QLabel>
 #include <QButtonGroup>
+#include <QElapsedTimer>
 #include <QPushButton>
 #include <QRadioButton>
 #include <QHBoxLayout>
-#include <QListWidget>
+#include <QLineEdit>
+#include <QListView>
 #include <QProcess>
+#include <QStackedWidget>
+#include <QTimer>
+
+#include "BookCatalogue.h"
+#include "BookExtractor.h"
+#include "BookListSync.h"
+#include "BookListModel.h"
+#include "ClozeGenerator.h"
+#include "LibraryImportJob.h"
+
+#include "QuestionBank.h"
+#include "QuestionFingerprints.h"
+#include "QuizCache.h"
+#include "QuizConfig.h"
+#include "QuizClient.h"
+#include "QuizHistory.h"
+#include "QuizItem.h"
+#include "QuizPrefetcher.h"
+#include "QuizTimings.h"
+#include "RepaintTrace.h"
 
 // Script paths
-const QString QUIZ_SCRIPT_PATH = "/mnt/onboard/.adds/quiz/generateQuiz.sh";
-const QString BOOKS_LIST_PATH = "/mnt/onboard/.adds/quiz/books.json";
-const QString UPDATE_BOOKS_SCRIPT_PATH = "/mnt/onboard/.adds/quiz/updateBooks.sh";
-
-struct QuizItem {
-    QString question;
-    QStringList options;
-    QString correctAnswer;
-    QString explanation;
-};
+const QString UPDATE_BOOKS_SCRIPT_PATH = ONBOARD_ROOT + "/.adds/quiz/updateBooks.sh";
 
 class QuizGenerator : public QObject, public NPGuiInterface
 {
@@ -34,35 +47,114 @@ class QuizGenerator : public QObject, public NPGuiInterface
 
     public:
         QuizGenerator();
-        ~QuizGenerator() {
-            clearCurrentLayout();
-        }
+        ~QuizGenerator() = default;
         void showUi();
 
     protected:
         bool eventFilter(QObject *obj, QEvent *event) override;
 
     private:
+        // What the primary quiz button does on the current screen
+        enum class QuizMode { Answering, Score, Review };
+
         void updateQuestion();
         void onSubmitClicked();
+        void onPrimaryClicked();
         void showFinalScore();
         void showError(const QString& message);
 
         // New methods for book selection
         void showBookSelection();
         void onBookSelected();
+        void onFreshQuizSelected();
+        void onReviewDueClicked();
+        void recordAnswers();
+        void bankNewQuestions();
+        void startQuiz(bool bypassCache);
         void generateQuizForBook(const QString &bookTitle);
+        bool startOfflineQuiz(const QString &bookTitle, QString *error);
+        void onBookExtracted(const QString &bookPath, bool ok);
+        void onExtractionWaitOver();
+        void onQuizItemReady(const QuizItem &item);
+        void onQuizReady(const QList<QuizItem> &items, const QStringList &dropped);
+        void onQuizFailed(const QString &message);
+        void showWaitingForQuestion();
+        void showRepeatedQuestions();
+        void onQuizProgress(qint64 elapsedMs, qint64 idleMs, int attempt);
+        void onCancelClicked();
+        void stopGenerating();
         void loadQuizQuestions();
         void showQuizUi();
         void handleBookScrollUp();
         void handleBookScrollDown();
+        void applyBookFilter(const QString &text);
 
         // New functions for review
         void onReviewClicked();
         void updateReviewQuestion();
         void onReviewNextClicked();
+        void onReviewPreviousClicked();
+        void onSwiped(NPDialog::SwipeDirection direction);
 
         NPDialog m_dlg;
+        QStackedWidget* m_stack = nullptr;
+        QWidget* m_selectionPage = nullptr;
+        QWidget* m_quizPage = nullptr;
+        QWidget* m_errorPage = nullptr;
+        QWidget* m_statsPage = nullptr;
+        QWidget* m_historyPage = nullptr;
+        QLabel* m_historyLabel = nullptr;
+        QuizMode m_quizMode = QuizMode::Answering;
+        QuizClient* m_quizClient = nullptr;
+        QuizCache m_quizCache;
+        QuestionBank m_bank;
+
+        // Finished quizzes, with the time spent on each question
+        QuizHistory m_history;
+        QDateTime m_sessionStarted;
+        QElapsedTimer m_sessionTimer;
+        QElapsedTimer m_questionTimer;
+        QList<qint32> m_answerMs;
+
+        // Generated questions that repeat earlier ones are held back and
+        // used only when nothing new arrives
+        QuestionFingerprints m_seen;
+        QList<QuizItem> m_duplicates;
+        int m_droppedCount = 0;        // Malformed questions skipped this run
+
+        // A quiz is requested in batches: the first opens the quiz and the
+        // rest are fetched while the user answers
+        int m_quizLength = 3;
+        int m_batchSize = 3;
+        int m_batchesLeft = 0;
+        QList<int> m_sessionIds;       // Bank ids of the current quiz, in quiz order
+        bool m_answersRecorded = false;
+        QPushButton* m_reviewDueButton = nullptr;
+        QuizPrefetcher* m_prefetcher = nullptr;
+        BookListSync* m_bookSync = nullptr;
+        LibraryImportJob* m_libraryImport = nullptr;
+        bool m_libraryImportShown = false; // The Import button is waiting on it
+
+        // The book's text is split into chunks on a worker thread the
+        // first time it is quizzed; generation waits a little for it
+        BookExtractor* m_extractor = nullptr;
+        QTimer m_extractionWait;
+        QString m_extractingPath;
+        RepaintTrace* m_repaintTrace = nullptr;
+
+        // Per-stage latency, shown on the hidden stats screen
+        QuizTimings m_timings;
+        QElapsedTimer m_generateTimer;
+        QElapsedTimer m_tapTimer;
+        bool m_firstPaintPending = false;
+        QLabel* m_titleLabel = nullptr;
+        QLabel* m_statsLabel = nullptr;
+        QElapsedTimer m_titleTaps;
+        int m_titleTapCount = 0;
+        QString m_currentBook;
+        bool m_generating = false;         // More questions are still streaming in
+        bool m_quizShown = false;          // The current run has opened the quiz UI
+        bool m_waitingForQuestion = false; // The user has answered every question so far
         QLabel* m_questionLabel = nullptr;
         QButtonGroup* m_buttonGroup = nullptr;
         QPushButton* m_submitButton = nullptr;
@@ -72,26 +164,48 @@ class QuizGenerator : public QObject, public NPGuiInterface
         int m_score;
         bool m_uiInitialized = false; // Track if UI is initialized
         QList<QRadioButton*> m_optionButtons; // Keep references to radio buttons
+        QList<QLabel*> m_optionLabels;
+        QList<QWidget*> m_optionWidgets;
         QStringList m_userAnswers;  // To store user's answers
 
-        QHBoxLayout* m_buttonLayout = nullptr; // To hold the buttons at the end
-        QListWidget* m_bookListWidget = nullptr;
+        QListView* m_bookListView = nullptr;
+        QLineEdit* m_filterEdit = nullptr;
+        BookCatalogue m_catalogue;
+        BookListModel* m_bookModel = nullptr;
         QPushButton* m_bookScrollUpButton = nullptr;
         QPushButton* m_bookScrollDownButton = nullptr;
 
         // Error dialog widgets
-        QWidget* m_errorWidget = nullptr;
         QLabel* m_errorLabel = nullptr;
         QPushButton* m_errorButton = nullptr;
 
         // Status label for feedback
         QLabel* m_statusLabel = nullptr;
 
+        // Shown while a quiz is being generated
+        QLabel* m_loadingLabel = nullptr;
+        QPushButton* m_cancelButton = nullptr;
+
         // Helper methods
-        void clearCurrentLayout();
-        QWidget* createOptionWidget(int index, const QString &text);
+        void ensureUi();
+        QWidget* buildSelectionPage();
+        QWidget* buildQuizPage();
+        QWidget* buildErrorPage();
+        QWidget* buildStatsPage();
+        void showStats();
+        QWidget* buildHistoryPage();
+        void showHistory();
+        void showPage(QWidget *page);
+        QWidget* createOptionWidget(QWidget *parent, int index);
         void showStatusMessage(const QString& message, bool isError = false);
+        void runImport();
         void runImportScript();
+        void runLibraryImport();
+        void runServerImport();
+        void onServerImportFinished(bool ok, bool changed, const QString &error);
+        void onLibraryImportFinished(bool ok, bool changed, const QString &error);
+        void preconnect();
+        bool usesLibraryImport() const;
 
         QLabel* m_explanationLabel = nullptr;
 };
@@ -0,0 +1,257 @@
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "QuizHistory.h"
+
+static const quint32 SUMMARY_MAGIC = 0x515a4853; // "QZHS"
+static const quint32 SUMMARY_VERSION = 1;
+static const int RECENT_SESSIONS = 20;
+
+// A length prefix lets a replay skip the question texts it does not need
+// and find where a partially written trailing record starts
+static bool readRecord(QDataStream &in, QuizHistory::Entry &entry, qint64 &durationMs)
+{
+    quint32 length;
+    in >> length;
+    if (in.status() != QDataStream::Ok || length > 16 * 1024 * 1024) {
+        return false;
+    }
+    QByteArray payload(int(length), Qt::Uninitialized);
+    if (in.readRawData(payload.data(), int(length)) != int(length)) {
+        return false;
+    }
+
+    QDataStream record(payload);
+    record.setVersion(QDataStream::Qt_5_0);
+    qint32 score, total;
+    record >> entry.started >> durationMs >> entry.book >> score >> total;
+    entry.score = score;
+    entry.total = total;
+    return record.status() == QDataStream::Ok;
+}
+
+QuizHistory::QuizHistory(const QString &logPath, const QString &summaryPath)
+    : m_logPath(logPath)
+    , m_summaryPath(summaryPath)
+{
+}
+
+void QuizHistory::append(const QuizSession &session)
+{
+    if (!load()) {
+        return;
+    }
+
+    Entry entry;
+    entry.started = session.started.toMSecsSinceEpoch();
+    entry.book = session.book;
+    entry.total = session.items.size();
+    for (int i = 0; i < session.items.size() && i < session.answers.size(); ++i) {
+        if (session.answers.at(i) == session.items.at(i).correctAnswer) {
+            ++entry.score;
+        }
+    }
+
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_0);
+        out << entry.started << session.durationMs << entry.book << qint32(entry.score) << qint32(entry.total);
+        for (int i = 0; i < session.items.size(); ++i) {
+            const QuizItem &item = session.items.at(i);
+            out << item.question << item.correctAnswer << session.answers.value(i)
+                << qint32(session.answerMs.value(i));
+        }
+    }
+
+    // Sessions logged since the totals were read are counted, and a torn
+    // record cut off, before this one goes after them
+    if (QFileInfo(m_logPath).size() > m_covered) {
+        replay(m_covered);
+    }
+
+    QDir().mkpath(QFileInfo(m_logPath).absolutePath());
+    QFile log(m_logPath);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "QuizHistory: unable to write" << m_logPath;
+        return;
+    }
+    QDataStream out(&log);
+    out << quint32(payload.size());
+    out.writeRawData(payload.constData(), payload.size());
+    log.close();
+
+    // Only this session is new to the totals, unless another writer got
+    // in first, in which case the gap is replayed
+    if (m_covered + 4 + payload.size() == QFileInfo(m_logPath).size()) {
+        apply(entry, session.durationMs);
+        m_covered += 4 + payload.size();
+    } else {
+        replay(m_covered);
+    }
+    saveSummary();
+}
+
+int QuizHistory::sessionCount()
+{
+    return load() ? m_sessions : 0;
+}
+
+QList<QuizHistory::BookStats> QuizHistory::books()
+{
+    return load() ? m_books : QList<BookStats>();
+}
+
+QList<QuizHistory::Entry> QuizHistory::recent()
+{
+    return load() ? m_recent : QList<Entry>();
+}
+
+bool QuizHistory::load()
+{
+    if (m_loaded) {
+        return true;
+    }
+
+    qint64 logSize = QFileInfo(m_logPath).size();
+    if (!loadSummary() || m_covered > logSize) {
+        m_covered = 0;
+        m_sessions = 0;
+        m_books.clear();
+        m_recent.clear();
+    }
+    if (m_covered < logSize) {
+        replay(m_covered);
+        saveSummary();
+    }
+
+    m_loaded = true;
+    return true;
+}
+
+bool QuizHistory::loadSummary()
+{
+    QFile file(m_summaryPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    qint32 sessions, bookCount, recentCount;
+    in >> magic >> version >> m_covered >> sessions >> bookCount;
+    if (in.status() != QDataStream::Ok || magic != SUMMARY_MAGIC || version != SUMMARY_VERSION) {
+        return false;
+    }
+    m_sessions = sessions;
+
+    m_books.clear();
+    for (int i = 0; i < bookCount && in.status() == QDataStream::Ok; ++i) {
+        BookStats stats;
+        qint32 count, questions, correct, best;
+        in >> stats.book >> count >> questions >> correct >> best >> stats.lastPlayed >> stats.totalMs;
+        stats.sessions = count;
+        stats.questions = questions;
+        stats.correct = correct;
+        stats.bestPercent = best;
+        m_books.append(stats);
+    }
+
+    m_recent.clear();
+    in >> recentCount;
+    for (int i = 0; i < recentCount && in.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        qint32 score, total;
+        in >> entry.started >> entry.book >> score >> total;
+        entry.score = score;
+        entry.total = total;
+        m_recent.append(entry);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+void QuizHistory::replay(qint64 from)
+{
+    QFile log(m_logPath);
+    if (!log.open(QIODevice::ReadOnly) || !log.seek(from)) {
+        return;
+    }
+
+    QDataStream in(&log);
+    bool damaged = false;
+    while (!in.atEnd()) {
+        qint64 start = log.pos();
+        Entry entry;
+        qint64 durationMs = 0;
+        if (!readRecord(in, entry, durationMs)) {
+            qWarning() << "QuizHistory: dropping a damaged record at" << start;
+            damaged = true;
+            break;
+        }
+        apply(entry, durationMs);
+        m_covered = log.pos();
+    }
+    log.close();
+
+    // A record torn by power loss would otherwise sit in front of every
+    // session appended after it, and replay would never get past it
+    if (damaged && !QFile::resize(m_logPath, m_covered)) {
+        qWarning() << "QuizHistory: unable to truncate" << m_logPath;
+    }
+}
+
+void QuizHistory::apply(const Entry &entry, qint64 durationMs)
+{
+    ++m_sessions;
+    m_recent.prepend(entry);
+    while (m_recent.size() > RECENT_SESSIONS) {
+        m_recent.removeLast();
+    }
+
+    // The list stays ordered by last play, so the book moves to the front
+    BookStats stats;
+    stats.book = entry.book;
+    for (int i = 0; i < m_books.size(); ++i) {
+        if (m_books.at(i).book == entry.book) {
+            stats = m_books.takeAt(i);
+            break;
+        }
+    }
+    stats.sessions++;
+    stats.questions += entry.total;
+    stats.correct += entry.score;
+    if (entry.total > 0) {
+        stats.bestPercent = qMax(stats.bestPercent, entry.score * 100 / entry.total);
+    }
+    stats.lastPlayed = qMax(stats.lastPlayed, entry.started);
+    stats.totalMs += durationMs;
+    m_books.prepend(stats);
+}
+
+void QuizHistory::saveSummary()
+{
+    QDir().mkpath(QFileInfo(m_summaryPath).absolutePath());
+    QSaveFile file(m_summaryPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "QuizHistory: unable to write" << m_summaryPath;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << SUMMARY_MAGIC << SUMMARY_VERSION << m_covered << qint32(m_sessions) << qint32(m_books.size());
+    for (const BookStats &stats : m_books) {
+        out << stats.book << qint32(stats.sessions) << qint32(stats.questions) << qint32(stats.correct)
+            << qint32(stats.bestPercent) << stats.lastPlayed << stats.totalMs;
+    }
+    out << qint32(m_recent.size());
+    for (const Entry &entry : m_recent) {
+        out << entry.started << entry.book << qint32(entry.score) << qint32(entry.total);
+    }
+    file.commit();
+}
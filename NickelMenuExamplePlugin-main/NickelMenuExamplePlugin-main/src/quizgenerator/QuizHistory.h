@@ -0,0 +1,76 @@
+#ifndef QUIZ_HISTORY_H
+#define QUIZ_HISTORY_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "QuizConfig.h"
+#include "QuizItem.h"
+
+const QString HISTORY_LOG_PATH = ONBOARD_ROOT + "/.adds/quiz/history.log";
+const QString HISTORY_SUMMARY_PATH = ONBOARD_ROOT + "/.adds/quiz/history.summary";
+
+// One finished quiz, as it is written to the history log
+struct QuizSession {
+    QDateTime started;
+    qint64 durationMs = 0;
+    QString book;                 // Empty for a review of due questions
+    QList<QuizItem> items;
+    QStringList answers;          // Chosen option per question, empty if skipped
+    QList<qint32> answerMs;       // Time spent on each question
+};
+
+// Every finished quiz, appended to a length-prefixed binary log that is
+// never rewritten. Per-book totals and the latest sessions live in a small
+// summary file that is updated after each session. The summary records
+// how much of the log it covers, so a missing or stale one is brought up
+// to date by replaying only the sessions after that point.
+class QuizHistory
+{
+    public:
+        struct BookStats {
+            QString book;
+            int sessions = 0;
+            int questions = 0;
+            int correct = 0;
+            int bestPercent = 0;
+            qint64 lastPlayed = 0;   // Milliseconds since the epoch
+            qint64 totalMs = 0;
+        };
+
+        struct Entry {
+            qint64 started = 0;
+            QString book;
+            int score = 0;
+            int total = 0;
+        };
+
+        explicit QuizHistory(const QString &logPath = HISTORY_LOG_PATH,
+                             const QString &summaryPath = HISTORY_SUMMARY_PATH);
+
+        void append(const QuizSession &session);
+
+        int sessionCount();
+        // Most recently played first
+        QList<BookStats> books();
+        QList<Entry> recent();
+
+    private:
+        bool load();
+        bool loadSummary();
+        void replay(qint64 from);
+        void apply(const Entry &entry, qint64 durationMs);
+        void saveSummary();
+
+        QString m_logPath;
+        QString m_summaryPath;
+        bool m_loaded = false;
+        qint64 m_covered = 0;       // Log bytes reflected in the totals
+        int m_sessions = 0;
+        QList<BookStats> m_books;
+        QList<Entry> m_recent;      // Newest first
+};
+
+#endif // QUIZ_HISTORY_H
@@ -0,0 +1,14 @@
+#ifndef QUIZ_ITEM_H
+#define QUIZ_ITEM_H
+
+#include <QString>
+#include <QStringList>
+
+struct QuizItem {
+    QString question;
+    QStringList options;
+    QString correctAnswer;
+    QString explanation;
+};
+
+#endif // QUIZ_ITEM_H
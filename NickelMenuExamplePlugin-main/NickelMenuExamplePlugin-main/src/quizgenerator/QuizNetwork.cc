@@ -0,0 +1,63 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QSslConfiguration>
+#include <QtNetwork/QSslSocket>
+
+#include "QuizNetwork.h"
+
+// Servers commonly drop idle keep-alive connections after 30 to 60 seconds
+static const qint64 PRECONNECT_INTERVAL_MS = 30000;
+
+// Resumption relies on the shared manager, which caches sessions per
+// host, and on session sharing being on. Sessions last while Nickel runs;
+// persisting sessionTicket() would let them survive a restart.
+static QSslConfiguration sslConfiguration()
+{
+    QSslConfiguration configuration = QSslConfiguration::defaultConfiguration();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+#endif
+    return configuration;
+}
+
+QNetworkAccessManager* QuizNetwork::manager()
+{
+    // Owned by the application, so it outlives every dialog and client
+    static QNetworkAccessManager *manager = new QNetworkAccessManager(QCoreApplication::instance());
+    return manager;
+}
+
+void QuizNetwork::prepare(QNetworkRequest &request)
+{
+    if (request.url().scheme() == "https") {
+        request.setSslConfiguration(sslConfiguration());
+    }
+}
+
+void QuizNetwork::preconnect(const QUrl &url)
+{
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+
+    static QHash<QString, QElapsedTimer> lastAttempt;
+    QString key = url.scheme() + "://" + url.host() + ":" + QString::number(url.port());
+    QElapsedTimer &timer = lastAttempt[key];
+    if (timer.isValid() && timer.elapsed() < PRECONNECT_INTERVAL_MS) {
+        return;
+    }
+    timer.start();
+
+    // The configuration has to match the later request's for the
+    // connection to be picked up again
+    if (url.scheme() == "https") {
+        if (QSslSocket::supportsSsl()) {
+            manager()->connectToHostEncrypted(url.host(), quint16(url.port(443)), sslConfiguration());
+        }
+    } else if (url.scheme() == "http") {
+        manager()->connectToHost(url.host(), quint16(url.port(80)));
+    }
+}
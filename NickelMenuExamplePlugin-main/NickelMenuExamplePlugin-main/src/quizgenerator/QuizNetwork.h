@@ -0,0 +1,26 @@
+#ifndef QUIZ_NETWORK_H
+#define QUIZ_NETWORK_H
+
+#include <QUrl>
+
+class QNetworkAccessManager;
+class QNetworkRequest;
+
+// The plugin's single QNetworkAccessManager. Quiz, prefetch and import
+// requests all go through it, so they share its keep-alive connections
+// and TLS sessions instead of each paying for DNS, TCP and a handshake.
+class QuizNetwork
+{
+    public:
+        static QNetworkAccessManager* manager();
+
+        // Lets a new connection resume an earlier TLS session, on Qt 5.5
+        // and later
+        static void prepare(QNetworkRequest &request);
+
+        // Opens a connection to the URL's host ahead of the first request,
+        // at most once per keep-alive window per host
+        static void preconnect(const QUrl &url);
+};
+
+#endif // QUIZ_NETWORK_H
@@ -0,0 +1,212 @@
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+
+#include "QuizCache.h"
+#include "QuizClient.h"
+#include "QuizConfig.h"
+#include "QuizPrefetcher.h"
+
+// Consecutive failures after which the Wi-Fi window is assumed to be gone
+static const int MAX_CONSECUTIVE_FAILURES = 3;
+
+QuizPrefetcher::QuizPrefetcher(QuizCache *cache, QObject *parent)
+    : QObject(parent)
+    , m_cache(cache)
+{
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &QuizPrefetcher::dispatch);
+    setConcurrency(1);
+}
+
+void QuizPrefetcher::setConcurrency(int concurrency)
+{
+    concurrency = qBound(1, concurrency, 4);
+    while (m_clients.size() < concurrency) {
+        int slot = m_clients.size();
+        QuizClient *client = new QuizClient(this);
+        connect(client, &QuizClient::quizReady, this, [this, slot](const QList<QuizItem> &items) {
+            onReady(slot, items);
+        });
+        connect(client, &QuizClient::quizFailed, this, [this, slot](const QString &) {
+            onFailed(slot);
+        });
+        m_clients.append(client);
+        m_slotTitles.append(QString());
+    }
+}
+
+void QuizPrefetcher::setDelay(int msecs)
+{
+    m_timer.setInterval(qMax(0, msecs));
+}
+
+void QuizPrefetcher::start(const QStringList &bookTitles)
+{
+    // Offline quizzes are built on demand and never cached
+    if (isRunning() || QuizConfig::load().value("QUIZ_BACKEND") == "cloze") {
+        return;
+    }
+
+    m_failures = 0;
+    loadQueue(bookTitles);
+    if (!m_queue.isEmpty()) {
+        m_timer.start();
+    }
+}
+
+void QuizPrefetcher::pause()
+{
+    m_paused = true;
+
+    // In-flight requests give their backend slots to the foreground quiz,
+    // which would otherwise wait behind them (the local backend has one),
+    // and go back to the front of the queue
+    for (int slot = m_clients.size() - 1; slot >= 0; --slot) {
+        if (!m_slotTitles.at(slot).isEmpty()) {
+            m_clients.at(slot)->cancel();
+            m_queue.prepend(m_slotTitles.at(slot));
+            m_slotTitles[slot].clear();
+        }
+    }
+    if (m_timer.isActive()) {
+        saveQueue();
+    }
+}
+
+void QuizPrefetcher::resume()
+{
+    m_paused = false;
+}
+
+void QuizPrefetcher::loadQueue(const QStringList &bookTitles)
+{
+    m_queue.clear();
+
+    // Resume the saved queue unless books.json has changed since
+    QFileInfo queueInfo(PREFETCH_QUEUE_PATH);
+    if (queueInfo.exists() && queueInfo.lastModified() >= QFileInfo(BOOKS_LIST_PATH).lastModified()) {
+        QFile file(PREFETCH_QUEUE_PATH);
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream in(&file);
+            in.setCodec("UTF-8");
+            QSet<QString> known = QSet<QString>::fromList(bookTitles);
+            while (!in.atEnd()) {
+                QString title = in.readLine();
+                if (known.contains(title)) {
+                    m_queue.append(title);
+                }
+            }
+            return;
+        }
+    }
+
+    for (const QString &title : bookTitles) {
+        if (!title.isEmpty() && !m_cache->contains(title)) {
+            m_queue.append(title);
+        }
+    }
+    saveQueue();
+}
+
+void QuizPrefetcher::saveQueue()
+{
+    if (m_queue.isEmpty() && inFlight() == 0) {
+        QFile::remove(PREFETCH_QUEUE_PATH);
+        return;
+    }
+
+    // In-flight titles stay queued until their quiz is cached
+    QSaveFile file(PREFETCH_QUEUE_PATH);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    for (const QString &title : m_slotTitles) {
+        if (!title.isEmpty()) {
+            out << title << '\n';
+        }
+    }
+    for (const QString &title : m_queue) {
+        out << title << '\n';
+    }
+    out.flush();
+    file.commit();
+}
+
+void QuizPrefetcher::dispatch()
+{
+    if (m_paused) {
+        return;
+    }
+    if (m_queue.isEmpty()) {
+        if (inFlight() == 0) {
+            m_timer.stop();
+            saveQueue();
+        }
+        return;
+    }
+
+    // Launch at most one request per tick to keep the load low
+    for (int slot = 0; slot < m_clients.size(); ++slot) {
+        if (m_slotTitles.at(slot).isEmpty()) {
+            QString title = m_queue.takeFirst();
+            if (m_cache->contains(title)) {
+                saveQueue();
+                return;
+            }
+            m_slotTitles[slot] = title;
+            QuizRequest request;
+            request.bookTitle = title;
+            request.count = m_quizLength;
+            m_clients.at(slot)->generate(request);
+            return;
+        }
+    }
+}
+
+void QuizPrefetcher::onReady(int slot, const QList<QuizItem> &items)
+{
+    m_cache->store(m_slotTitles.at(slot), items);
+    m_slotTitles[slot].clear();
+    m_failures = 0;
+
+    // Once stopped, the queue file is left as the resume point
+    if (m_timer.isActive()) {
+        saveQueue();
+    }
+}
+
+void QuizPrefetcher::onFailed(int slot)
+{
+    QString title = m_slotTitles.at(slot);
+    m_slotTitles[slot].clear();
+    if (!m_timer.isActive()) {
+        return;
+    }
+
+    // Retry the book after the rest of the queue
+    m_queue.append(title);
+    saveQueue();
+
+    if (++m_failures >= MAX_CONSECUTIVE_FAILURES) {
+        qWarning() << "QuizPrefetcher: stopping after repeated failures";
+        m_timer.stop();
+        m_queue.clear();
+    }
+}
+
+int QuizPrefetcher::inFlight() const
+{
+    int count = 0;
+    for (const QString &title : m_slotTitles) {
+        if (!title.isEmpty()) {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,55 @@
+#ifndef QUIZ_PREFETCHER_H
+#define QUIZ_PREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "QuizConfig.h"
+#include "QuizItem.h"
+
+class QuizCache;
+class QuizClient;
+
+const QString PREFETCH_QUEUE_PATH = ONBOARD_ROOT + "/.adds/quiz/prefetch.queue";
+
+// Generates and caches quizzes for uncached books while Wi-Fi is up.
+// Work is paced and paused during foreground generation, which takes over
+// the slots of any requests in flight. The pending titles are kept on disk
+// so an interrupted run resumes next time.
+class QuizPrefetcher : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit QuizPrefetcher(QuizCache *cache, QObject *parent = nullptr);
+
+        void setConcurrency(int concurrency);
+        void setDelay(int msecs);
+        void setQuizLength(int count) { m_quizLength = qMax(1, count); }
+        void start(const QStringList &bookTitles);
+        void pause();
+        void resume();
+        bool isRunning() const { return !m_queue.isEmpty() || inFlight() > 0; }
+
+    private:
+        void loadQueue(const QStringList &bookTitles);
+        void saveQueue();
+        void dispatch();
+        void onReady(int slot, const QList<QuizItem> &items);
+        void onFailed(int slot);
+        int inFlight() const;
+
+        QuizCache* m_cache;
+        QList<QuizClient*> m_clients;
+        QStringList m_slotTitles;   // Title in flight per client, empty when idle
+        QStringList m_queue;
+        QTimer m_timer;
+        bool m_paused = false;
+        int m_failures = 0;
+        int m_quizLength = 3;
+};
+
+#endif // QUIZ_PREFETCHER_H
@@ -0,0 +1,216 @@
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegExp>
+
+#include "QuizStreamParser.h"
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Removes commas directly before a closing brace or bracket, outside strings
+static QByteArray withoutTrailingCommas(const QByteArray &json)
+{
+    QByteArray out;
+    out.reserve(json.size());
+    bool inString = false, escaped = false;
+    for (char c : json) {
+        if (inString) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '}' || c == ']') {
+            int end = out.size();
+            while (end > 0 && isBlank(out.at(end - 1))) {
+                --end;
+            }
+            if (end > 0 && out.at(end - 1) == ',') {
+                out.remove(end - 1, 1);
+            }
+        }
+        out.append(c);
+    }
+    return out;
+}
+
+void QuizStreamParser::reset()
+{
+    m_state = Searching;
+    m_object.clear();
+    m_depth = 0;
+    m_objectIndex = 0;
+    m_inString = false;
+    m_escaped = false;
+    m_ready.clear();
+    m_problems.clear();
+}
+
+QList<QuizItem> QuizStreamParser::feed(const QByteArray &data)
+{
+    for (int i = 0; i < data.size() && m_state != Finished; ++i) {
+        char c = data.at(i);
+
+        if (m_state == Searching) {
+            if (c == '[') {
+                m_state = ArrayOpened;
+            }
+            continue;
+        }
+        if (m_state == ArrayOpened) {
+            if (c == '{') {
+                m_state = InArray;
+            } else if (c == ']') {
+                m_state = Finished;
+                continue;
+            } else {
+                // "[Note]" in prose, not the array
+                if (!isBlank(c)) {
+                    m_state = c == '[' ? ArrayOpened : Searching;
+                }
+                continue;
+            }
+        }
+
+        if (m_depth > 0) {
+            m_object.append(c);
+        }
+
+        if (m_inString) {
+            if (m_escaped) {
+                m_escaped = false;
+            } else if (c == '\\') {
+                m_escaped = true;
+            } else if (c == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            m_inString = true;
+        } else if (c == '{') {
+            if (m_depth++ == 0) {
+                m_object = "{";
+                ++m_objectIndex;
+            }
+        } else if (c == '}' && m_depth > 0) {
+            if (--m_depth == 0) {
+                endObject();
+            }
+        } else if (c == ']' && m_depth == 0) {
+            m_state = Finished;
+        }
+    }
+
+    QList<QuizItem> items = m_ready;
+    m_ready.clear();
+    return items;
+}
+
+void QuizStreamParser::endObject()
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(m_object, &error);
+    if (!doc.isObject()) {
+        doc = QJsonDocument::fromJson(withoutTrailingCommas(m_object), &error);
+    }
+    m_object.clear();
+
+    QString reason;
+    if (!doc.isObject()) {
+        reason = "malformed JSON (" + error.errorString() + ")";
+    } else {
+        QuizItem item = itemFromJson(doc.object());
+        if (validate(item, &reason)) {
+            m_ready.append(item);
+            return;
+        }
+    }
+
+    QString problem = QString("question %1: %2").arg(m_objectIndex).arg(reason);
+    qWarning() << "QuizStreamParser: dropped" << problem;
+    m_problems.append(problem);
+}
+
+void QuizStreamParser::finish()
+{
+    if (m_depth > 0) {
+        QString problem = QString("question %1: cut off before its end").arg(m_objectIndex);
+        qWarning() << "QuizStreamParser: dropped" << problem;
+        m_problems.append(problem);
+        m_object.clear();
+        m_depth = 0;
+    }
+}
+
+QString QuizStreamParser::failureMessage() const
+{
+    if (!foundArray()) {
+        return "Invalid quiz format generated.";
+    }
+    if (m_problems.isEmpty()) {
+        return "No questions were generated.";
+    }
+    return "No usable questions were generated: " + m_problems.join("; ") + ".";
+}
+
+QuizItem QuizStreamParser::itemFromJson(const QJsonObject &obj)
+{
+    QuizItem item;
+    item.question = obj["question"].toString();
+
+    for (const QJsonValue &option : obj["options"].toArray()) {
+        item.options.append(option.toString());
+    }
+
+    item.correctAnswer = obj["correct_answer"].toString();
+    item.explanation = obj["explanation"].toString();
+    return item;
+}
+
+bool QuizStreamParser::validate(QuizItem &item, QString *reason)
+{
+    item.question = item.question.trimmed();
+    if (item.question.isEmpty()) {
+        *reason = "no question text";
+        return false;
+    }
+    if (item.options.size() < 2 || item.options.size() > 4) {
+        *reason = QString("%1 options").arg(item.options.size());
+        return false;
+    }
+    if (item.options.contains(item.correctAnswer)) {
+        return true;
+    }
+
+    // The same text up to case and spacing, or the option's letter
+    QString answer = item.correctAnswer.simplified();
+    for (const QString &option : item.options) {
+        if (option.simplified().compare(answer, Qt::CaseInsensitive) == 0) {
+            item.correctAnswer = option;
+            return true;
+        }
+    }
+    QString letter = answer;
+    letter.remove(QRegExp("^(option|answer)\\s*", Qt::CaseInsensitive));
+    letter.remove(QRegExp("[().:]"));
+    letter = letter.trimmed();
+    if (letter.size() == 1) {
+        int index = letter.at(0).toUpper().unicode() - 'A';
+        if (index >= 0 && index < item.options.size()) {
+            item.correctAnswer = item.options.at(index);
+            return true;
+        }
+    }
+
+    *reason = item.correctAnswer.isEmpty() ? "no correct answer" : "correct answer is not one of the options";
+    return false;
+}
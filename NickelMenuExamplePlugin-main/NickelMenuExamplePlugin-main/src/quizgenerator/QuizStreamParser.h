@@ -0,0 +1,56 @@
+#ifndef QUIZ_STREAM_PARSER_H
+#define QUIZ_STREAM_PARSER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+
+#include "QuizItem.h"
+
+// Incrementally extracts question objects from a JSON array as it
+// arrives. Each object is returned as soon as its closing brace is seen.
+// Replies are often not clean JSON, so the parser is lenient:
+// - prose and code fences around the array are skipped; the array is the
+//   first '[' whose next non-blank character is '{';
+// - trailing commas inside a question are tolerated;
+// - a malformed or incomplete question is dropped without losing the
+//   others, and so is a question that fails validation. A correct answer
+//   given as a letter ("B", "Option B") is mapped to its option.
+// dropped() names every dropped question and the reason.
+class QuizStreamParser
+{
+    public:
+        void reset();
+        QList<QuizItem> feed(const QByteArray &data);
+
+        // Call once the reply is complete, to report a cut-off question
+        void finish();
+
+        bool foundArray() const { return m_state == InArray || m_state == Finished; }
+
+        // A one-line explanation for a reply that yielded no questions
+        QString failureMessage() const;
+
+        // "question <n>: <reason>" for each question dropped so far
+        QStringList dropped() const { return m_problems; }
+
+        static QuizItem itemFromJson(const QJsonObject &obj);
+        static bool validate(QuizItem &item, QString *reason);
+
+    private:
+        enum State { Searching, ArrayOpened, InArray, Finished };
+
+        void endObject();
+
+        State m_state = Searching;
+        QByteArray m_object;
+        int m_depth = 0;
+        int m_objectIndex = 0;
+        bool m_inString = false;
+        bool m_escaped = false;
+        QList<QuizItem> m_ready;
+        QStringList m_problems;
+};
+
+#endif // QUIZ_STREAM_PARSER_H
@@ -0,0 +1,112 @@
+#include <QStyle>
+#include <QWidget>
+
+#include "QuizTheme.h"
+
+const char QUIZ_THEME[] =
+    "QPushButton {"
+    "    font-size: 28px;"
+    "    padding: 10px;"
+    "    margin: 10px;"
+    "    min-width: 150px;"
+    "}"
+    "QPushButton#importButton, QPushButton#reviewDueButton, QPushButton#historyButton,"
+    " QPushButton[role=\"scroll\"] {"
+    "    background-color: #000000;"
+    "    border: none;"
+    "    border-radius: 10px;"
+    "    color: #ffffff;"
+    "    margin: 0px;"
+    "}"
+    "QPushButton#importButton, QPushButton#reviewDueButton, QPushButton#historyButton {"
+    "    padding: 10px 20px;"
+    "    min-width: 100px;"
+    "}"
+    "QPushButton[role=\"scroll\"] {"
+    "    padding: 15px;"
+    "    min-width: 60px;"
+    "}"
+    "QPushButton#importButton:pressed, QPushButton#reviewDueButton:pressed, QPushButton#historyButton:pressed,"
+    " QPushButton[role=\"scroll\"]:pressed {"
+    "    background-color: #333333;"
+    "}"
+    "QLineEdit, QListView {"
+    "    font-size: 32px;"
+    "    margin: 10px;"
+    "}"
+    "QLineEdit {"
+    "    padding: 5px;"
+    "}"
+    "QPushButton#reviewDueButton:disabled {"
+    "    background-color: #999999;"
+    "}"
+    "QListView:disabled {"
+    "    color: gray;"
+    "}"
+    "QLabel#titleLabel {"
+    "    font-size: 38px;"
+    "    margin: 10px;"
+    "    padding: 5px;"
+    "}"
+    "QLabel#loadingLabel, QLabel#errorLabel {"
+    "    font-size: 32px;"
+    "    margin: 10px;"
+    "    padding: 5px;"
+    "}"
+    "QLabel#statusLabel {"
+    "    font-size: 28px;"
+    "    padding: 10px;"
+    "    border-radius: 5px;"
+    "}"
+    "QLabel#statusLabel[state=\"ok\"] {"
+    "    background-color: #e8f5e9;"
+    "    color: #2e7d32;"
+    "}"
+    "QLabel#statusLabel[state=\"error\"] {"
+    "    background-color: #ffebee;"
+    "    color: #c62828;"
+    "}"
+    "QLabel#questionLabel {"
+    "    font-size: 55px;"
+    "    margin: 10px;"
+    "    padding: 5px;"
+    "}"
+    "QLabel[role=\"option\"] {"
+    "    font-size: 38px;"
+    "    margin: 5px;"
+    "    padding: 5px;"
+    "}"
+    "QLabel[role=\"option\"][state=\"correct\"] {"
+    "    color: green;"
+    "}"
+    "QLabel[role=\"option\"][state=\"wrong\"] {"
+    "    color: red;"
+    "}"
+    "QLabel#explanationLabel {"
+    "    font-size: 28px;"
+    "    padding: 15px;"
+    "    margin: 10px;"
+    "    background-color: #f5f5f5;"
+    "    border: 2px solid #e0e0e0;"
+    "    border-radius: 10px;"
+    "}"
+    "QLabel#historyLabel {"
+    "    font-size: 28px;"
+    "    margin: 10px;"
+    "}"
+    "QLabel#statsLabel {"
+    "    font-family: monospace;"
+    "    font-size: 26px;"
+    "    margin: 10px;"
+    "}";
+
+void setStyleState(QWidget *widget, const char *name, const QVariant &value)
+{
+    if (widget->property(name) == value) {
+        return;
+    }
+
+    widget->setProperty(name, value);
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+}
@@ -0,0 +1,17 @@
+#ifndef QUIZTHEME_H
+#define QUIZTHEME_H
+
+#include <QVariant>
+
+class QWidget;
+
+// Stylesheet for the whole dialog. It is set once on the dialog and widgets
+// pick up their rules through object names and the "role" and "state"
+// dynamic properties.
+extern const char QUIZ_THEME[];
+
+// Sets a property the theme selects on and re-polishes the widget, but only
+// when the value actually changes
+void setStyleState(QWidget *widget, const char *name, const QVariant &value);
+
+#endif // QUIZTHEME_H
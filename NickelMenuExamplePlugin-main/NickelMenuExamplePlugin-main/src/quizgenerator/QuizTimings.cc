@@ -0,0 +1,134 @@
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+
+#include "QuizTimings.h"
+
+// Nearest-rank percentile of sorted samples
+static qint64 percentile(const QVector<qint64> &sorted, int pct)
+{
+    int rank = (sorted.size() * pct + 99) / 100;
+    return sorted.at(qBound(0, rank - 1, sorted.size() - 1));
+}
+
+QuizTimings::Span::Span(QuizTimings *timings, const char *stage)
+    : m_timings(timings)
+    , m_stage(stage)
+{
+    m_timer.start();
+}
+
+QuizTimings::Span::~Span()
+{
+    if (m_timings) {
+        m_timings->record(m_stage, m_timer.nsecsElapsed() / 1000);
+    }
+}
+
+QuizTimings::QuizTimings(const QString &path, qint64 maxBytes)
+    : m_path(path)
+    , m_maxBytes(maxBytes)
+{
+}
+
+QuizTimings::~QuizTimings()
+{
+    flush();
+}
+
+void QuizTimings::record(const char *stage, qint64 usecs)
+{
+    m_pending.append(stage);
+    m_pending.append(' ');
+    m_pending.append(QByteArray::number(usecs));
+    m_pending.append('\n');
+}
+
+void QuizTimings::flush()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "QuizTimings: unable to write" << m_path;
+        return;
+    }
+    file.write(m_pending);
+    qint64 size = file.size();
+    file.close();
+    m_pending.clear();
+
+    if (size > m_maxBytes) {
+        trim();
+    }
+}
+
+void QuizTimings::trim()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    // Keep the newest half, starting on a line boundary
+    int start = data.indexOf('\n', data.size() / 2);
+    if (start < 0) {
+        return;
+    }
+
+    QByteArray kept = data.mid(start + 1);
+    QSaveFile trimmed(m_path);
+    if (trimmed.open(QIODevice::WriteOnly) && trimmed.write(kept) == kept.size()) {
+        trimmed.commit();
+    }
+}
+
+QList<QuizTimings::Stats> QuizTimings::stats()
+{
+    flush();
+
+    QList<Stats> result;
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return result;
+    }
+
+    QStringList order;
+    QHash<QString, QVector<qint64>> samples;
+    while (!file.atEnd()) {
+        QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+        if (fields.size() != 2) {
+            continue;
+        }
+        bool ok;
+        qint64 usecs = fields.at(1).toLongLong(&ok);
+        if (!ok) {
+            continue;
+        }
+
+        QString stage = QString::fromLatin1(fields.at(0));
+        if (!samples.contains(stage)) {
+            order.append(stage);
+        }
+        samples[stage].append(usecs);
+    }
+
+    for (const QString &stage : order) {
+        QVector<qint64> &values = samples[stage];
+        std::sort(values.begin(), values.end());
+        Stats stats = { stage, values.size(), percentile(values, 50), percentile(values, 95) };
+        result.append(stats);
+    }
+    return result;
+}
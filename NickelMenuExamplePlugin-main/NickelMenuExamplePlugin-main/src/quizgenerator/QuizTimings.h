@@ -0,0 +1,58 @@
+#ifndef QUIZ_TIMINGS_H
+#define QUIZ_TIMINGS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include "QuizConfig.h"
+
+const QString TIMINGS_LOG_PATH = ONBOARD_ROOT + "/.adds/quiz/timings.log";
+
+// Latency samples for each stage of the quiz flow, measured on the
+// monotonic clock. Samples are buffered and appended to a small text log
+// ("<stage> <microseconds>" per line) that is trimmed to its newest half
+// when it grows past maxBytes.
+class QuizTimings
+{
+    public:
+        struct Stats {
+            QString stage;
+            int count;
+            qint64 p50;
+            qint64 p95;
+        };
+
+        // Times a scope and records it as one sample of `stage`
+        class Span
+        {
+            public:
+                Span(QuizTimings *timings, const char *stage);
+                ~Span();
+
+            private:
+                QuizTimings* m_timings;
+                const char* m_stage;
+                QElapsedTimer m_timer;
+        };
+
+        explicit QuizTimings(const QString &path = TIMINGS_LOG_PATH, qint64 maxBytes = 64 * 1024);
+        ~QuizTimings();
+
+        void record(const char *stage, qint64 usecs);
+        void flush();
+
+        // Percentiles per stage over everything in the log, in first-seen order
+        QList<Stats> stats();
+
+    private:
+        void trim();
+
+        QString m_path;
+        qint64 m_maxBytes;
+        QByteArray m_pending;
+};
+
+#endif // QUIZ_TIMINGS_H
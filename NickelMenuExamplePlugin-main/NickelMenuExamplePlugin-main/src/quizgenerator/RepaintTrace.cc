@@ -0,0 +1,91 @@
+#include <QDebug>
+#include <QEvent>
+#include <QPaintEvent>
+#include <QWidget>
+
+#include "RepaintTrace.h"
+
+RepaintTrace::RepaintTrace(QWidget *root, QObject *parent)
+    : QObject(parent)
+    , m_root(root)
+{
+    // Paints run from a posted update request, so wait a moment before
+    // attributing them to the transition
+    m_reportTimer.setSingleShot(true);
+    m_reportTimer.setInterval(100);
+    connect(&m_reportTimer, &QTimer::timeout, this, &RepaintTrace::report);
+}
+
+void RepaintTrace::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+void RepaintTrace::watch()
+{
+    // Paint events are not seen by the parent, so every widget needs a filter
+    if (!m_enabled) {
+        return;
+    }
+
+    m_root->installEventFilter(this);
+    for (QWidget *widget : m_root->findChildren<QWidget*>()) {
+        widget->installEventFilter(this);
+    }
+}
+
+void RepaintTrace::beginTransition()
+{
+    if (!m_enabled) {
+        return;
+    }
+
+    // A report still pending belongs to the previous transition
+    if (m_reportTimer.isActive()) {
+        m_reportTimer.stop();
+        report();
+    }
+    m_dirty = QRegion();
+}
+
+void RepaintTrace::endTransition(const QString &name)
+{
+    if (m_enabled) {
+        m_transition = name;
+        m_reportTimer.start();
+    }
+}
+
+bool RepaintTrace::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::Paint) {
+        QWidget *widget = static_cast<QWidget*>(obj);
+        QRegion region = static_cast<QPaintEvent*>(event)->region();
+        if (widget != m_root) {
+            region.translate(widget->mapTo(m_root, QPoint(0, 0)));
+        }
+        m_dirty += region;
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void RepaintTrace::report()
+{
+    // rects() is deprecated from 5.8 on, the device's Qt predates begin()/end()
+    qint64 area = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    for (const QRect &rect : m_dirty) {
+#else
+    for (const QRect &rect : m_dirty.rects()) {
+#endif
+        area += qint64(rect.width()) * rect.height();
+    }
+    qint64 total = qMax(1LL, qint64(m_root->width()) * m_root->height());
+
+    // The trace is opt-in, so it is logged as a warning to stay visible
+    // where debug output is filtered out
+    qWarning().nospace() << "repaint " << m_transition << ": " << area << " px ("
+                       << (area * 100 / total) << "%), " << m_dirty.rectCount() << " rects, bounds "
+                       << m_dirty.boundingRect();
+    m_dirty = QRegion();
+}
@@ -0,0 +1,44 @@
+#ifndef REPAINT_TRACE_H
+#define REPAINT_TRACE_H
+
+#include <QObject>
+#include <QRegion>
+#include <QString>
+#include <QTimer>
+
+class QWidget;
+
+// Logs the area of the dialog repainted by each page change, to check that
+// navigation on the e-ink screen only redraws what changed. It measures and
+// never limits anything. Unless enabled, every call is a no-op.
+class RepaintTrace : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit RepaintTrace(QWidget *root, QObject *parent = nullptr);
+
+        void setEnabled(bool enabled);
+
+        // Watches every widget currently under the root; call once the
+        // screens have been built
+        void watch();
+
+        // Brackets the widget updates for one page change
+        void beginTransition();
+        void endTransition(const QString &name);
+
+    protected:
+        bool eventFilter(QObject *obj, QEvent *event) override;
+
+    private:
+        void report();
+
+        QWidget* m_root;
+        QRegion m_dirty;
+        QString m_transition;
+        QTimer m_reportTimer;
+        bool m_enabled = false;
+};
+
+#endif // REPAINT_TRACE_H
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Stand-in for generateQuiz.sh used by quizbench. Waits QUIZ_BENCH_LATENCY_MS
+# and prints QUIZ_BENCH_OUTPUT if set, otherwise a canned three-question quiz.
+sleep "$(awk "BEGIN { print ${QUIZ_BENCH_LATENCY_MS:-0} / 1000 }")"
+
+if [ -n "$QUIZ_BENCH_OUTPUT" ]; then
+    cat "$QUIZ_BENCH_OUTPUT"
+    exit $?
+fi
+
+cat <<JSON
+[
+  {"question": "Who wrote \"$1\"?", "options": ["The author", "Someone else", "Nobody", "Everybody"],
+   "correct_answer": "The author", "explanation": "Canned answer for benchmarking."},
+  {"question": "Which chapter comes first?", "options": ["One", "Two", "Three", "Four"],
+   "correct_answer": "One", "explanation": "Chapters are numbered in order."},
+  {"question": "Is this a benchmark?", "options": ["Yes", "No", "Maybe", "Later"],
+   "correct_answer": "Yes", "explanation": "The questions are fixed."}
+]
+JSON
@@ -0,0 +1,157 @@
+// Checks LibraryImporter against a fixture KoboReader.sqlite: a first full
+// import, an incremental one after a book is read, a full one after a book
+// is swapped for another (same count, and again with the same highest
+// rowid), and a no-op when nothing changed.
+// Run with QUIZ_ONBOARD_ROOT pointing at an empty directory; see `make test`.
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QThread>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <cstdio>
+
+#include "../LibraryImporter.h"
+
+static const char CONNECTION_NAME[] = "libraryfixture";
+static int g_failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    std::printf("%s %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) {
+        ++g_failures;
+    }
+}
+
+static bool exec(const QString &sql)
+{
+    QSqlQuery query(QSqlDatabase::database(CONNECTION_NAME));
+    if (!query.exec(sql)) {
+        std::fprintf(stderr, "libraryfixture: %s: %s\n", qPrintable(sql), qPrintable(query.lastError().text()));
+        return false;
+    }
+    return true;
+}
+
+// The columns of Nickel's content table that the importer reads
+static bool addBook(const QString &id, const QString &title, const QString &lastRead)
+{
+    return exec(QString("INSERT INTO content (ContentID, ContentType, IsDownloaded, Title, Attribution,"
+                        " DateLastRead, ___SyncTime) VALUES ('%1', 6, 'true', '%2', 'Author of %2', '%3', '%3')")
+                .arg(id, title, lastRead));
+}
+
+// Title to last_read, as written to books.json
+static QMap<QString, QString> listedBooks()
+{
+    QMap<QString, QString> books;
+    QFile file(BOOKS_LIST_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return books;
+    }
+    for (const QJsonValue &val : QJsonDocument::fromJson(file.readAll()).object()["books"].toArray()) {
+        QJsonObject obj = val.toObject();
+        books.insert(obj["title"].toString(), obj["last_read"].toString());
+    }
+    return books;
+}
+
+// The importer keys on the database mtime, which has millisecond resolution
+static bool runImport(LibraryImporter &importer)
+{
+    QThread::msleep(20);
+    QString error;
+    if (!importer.importBooks(&error)) {
+        std::fprintf(stderr, "libraryfixture: import failed: %s\n", qPrintable(error));
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (qgetenv("QUIZ_ONBOARD_ROOT").isEmpty()) {
+        std::fprintf(stderr, "libraryfixture: set QUIZ_ONBOARD_ROOT to an empty directory\n");
+        return 2;
+    }
+    QDir().mkpath(ONBOARD_ROOT + "/.kobo");
+    QDir().mkpath(ONBOARD_ROOT + "/.adds/quiz");
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+        db.setDatabaseName(KOBO_DATABASE_PATH);
+        if (!db.open()) {
+            std::fprintf(stderr, "libraryfixture: %s\n", qPrintable(db.lastError().text()));
+            return 1;
+        }
+    }
+
+    bool ok = exec("CREATE TABLE content (ContentID TEXT PRIMARY KEY, ContentType INTEGER, IsDownloaded TEXT,"
+                   " Title TEXT, Attribution TEXT, DateLastRead TEXT, ___SyncTime TEXT)")
+        && addBook("file:///mnt/onboard/a.epub", "Alpha", "2024-01-01T00:00:00Z")
+        && addBook("file:///mnt/onboard/b.epub", "Bravo", "2024-01-02T00:00:00Z")
+        && addBook("file:///mnt/onboard/c.epub", "Charlie", "2024-01-03T00:00:00Z")
+        // Not downloaded, so never listed
+        && exec("INSERT INTO content (ContentID, ContentType, IsDownloaded, Title) VALUES ('cloud', 6, 'false', 'Cloud')");
+    if (!ok) {
+        return 1;
+    }
+
+    LibraryImporter importer(KOBO_DATABASE_PATH);
+    if (!runImport(importer)) {
+        return 1;
+    }
+    QMap<QString, QString> books = listedBooks();
+    check(importer.changed(), "full import reports a change");
+    check(books.keys() == (QStringList() << "Alpha" << "Bravo" << "Charlie"), "full import lists the downloaded books");
+
+    ok = exec("UPDATE content SET DateLastRead = '2024-02-01T00:00:00Z' WHERE ContentID = 'file:///mnt/onboard/a.epub'");
+    if (!ok || !runImport(importer)) {
+        return 1;
+    }
+    books = listedBooks();
+    check(importer.changed(), "incremental import reports a change");
+    check(books.size() == 3, "incremental import keeps every book");
+    check(books.value("Alpha") == "2024-02-01T00:00:00Z", "incremental import picks up the new read date");
+
+    // Same count, different books
+    ok = exec("DELETE FROM content WHERE ContentID = 'file:///mnt/onboard/b.epub'")
+        && addBook("file:///mnt/onboard/d.epub", "Delta", "2023-12-01T00:00:00Z");
+    if (!ok || !runImport(importer)) {
+        return 1;
+    }
+    books = listedBooks();
+    check(importer.changed(), "swapped book reports a change");
+    check(!books.contains("Bravo"), "removed book is dropped");
+    check(books.contains("Delta"), "added book is listed even though it was read before the watermark");
+    check(books.size() == 3, "swap keeps the count");
+
+    // Same count and highest rowid: SQLite hands the deleted rowid to Echo
+    ok = exec("DELETE FROM content WHERE ContentID = 'file:///mnt/onboard/d.epub'")
+        && addBook("file:///mnt/onboard/e.epub", "Echo", "2023-11-01T00:00:00Z");
+    if (!ok || !runImport(importer)) {
+        return 1;
+    }
+    books = listedBooks();
+    check(!books.contains("Delta") && books.contains("Echo"), "book swapped into a reused rowid is caught");
+
+    if (!runImport(importer)) {
+        return 1;
+    }
+    check(!importer.changed(), "unchanged database reports no change");
+
+    QSqlDatabase::database(CONNECTION_NAME).close();
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+
+    std::printf("%s\n", g_failures ? "libraryfixture: FAILED" : "libraryfixture: passed");
+    return g_failures ? 1 : 0;
+}
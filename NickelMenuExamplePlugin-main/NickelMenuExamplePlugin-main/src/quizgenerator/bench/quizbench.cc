@@ -0,0 +1,413 @@
+// Drives the QuizGenerator plugin off the device: loads it under the
+// offscreen platform against a throwaway onboard directory, with stand-in
+// scripts, and walks import, book selection, answering and review.
+// For every flow it reports wall time, operator new calls and the number of
+// widgets under the dialog. With --backend local, quizzes come from a
+// stand-in model server on 127.0.0.1 instead of the script.
+
+#include <QAbstractItemModel>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QListView>
+#include <QMap>
+#include <QPluginLoader>
+#include <QPushButton>
+#include <QRegExp>
+#include <QRadioButton>
+#include <QStackedWidget>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+
+#include "../NPGuiInterface.h"
+
+// Every C++ allocation in the process, plugin and Qt included
+static std::atomic<long> g_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+struct Sample {
+    qint64 msecs;
+    long allocations;
+    int widgets;
+};
+
+static QMap<QString, QVector<Sample>> g_samples;
+static QStringList g_order;
+
+static bool writeFile(const QString &path, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+static bool installScript(const QString &from, const QString &to)
+{
+    QFile::remove(to);
+    return QFile::copy(from, to)
+        && QFile::setPermissions(to, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+}
+
+// Spins the event loop until `done` holds; the timer keeps waits short
+static bool waitFor(const std::function<bool()> &done, int timeoutMs = 30000)
+{
+    QTimer wake;
+    wake.start(5);
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+static QWidget* findDialog()
+{
+    for (QWidget *widget : QApplication::topLevelWidgets()) {
+        if (widget->inherits("NPDialog")) {
+            return widget;
+        }
+    }
+    return nullptr;
+}
+
+static QPushButton* findButton(QWidget *dialog, const QString &text)
+{
+    for (QPushButton *button : dialog->findChildren<QPushButton*>()) {
+        if (button->text() == text && button->isVisible() && button->isEnabled()) {
+            return button;
+        }
+    }
+    return nullptr;
+}
+
+static bool onPage(QWidget *dialog, const char *childName)
+{
+    QStackedWidget *stack = dialog->findChild<QStackedWidget*>();
+    return stack && stack->currentWidget() && stack->currentWidget()->findChild<QWidget*>(childName);
+}
+
+// Runs one flow and records how long it took to reach its end condition
+static bool measure(const QString &flow, const std::function<bool()> &run)
+{
+    long allocations = g_allocations;
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = run();
+    Sample sample = { timer.elapsed(), g_allocations - allocations, 0 };
+
+    if (QWidget *dialog = findDialog()) {
+        sample.widgets = dialog->findChildren<QWidget*>().size();
+    }
+    if (!ok) {
+        std::fprintf(stderr, "quizbench: flow '%s' did not complete\n", qPrintable(flow));
+        return false;
+    }
+
+    if (!g_samples.contains(flow)) {
+        g_order.append(flow);
+    }
+    g_samples[flow].append(sample);
+    return true;
+}
+
+// The canned quiz as a chat-completions event stream, one question per event
+static QByteArray cannedEventStream()
+{
+    static const char* const questions[] = {
+        "{\"question\": \"Who wrote this book?\", \"options\": [\"The author\", \"Someone else\", \"Nobody\", \"Everybody\"],"
+        " \"correct_answer\": \"The author\", \"explanation\": \"Canned answer for benchmarking.\"}",
+        "{\"question\": \"Which chapter comes first?\", \"options\": [\"One\", \"Two\", \"Three\", \"Four\"],"
+        " \"correct_answer\": \"One\", \"explanation\": \"Chapters are numbered in order.\"}",
+        "{\"question\": \"Is this a benchmark?\", \"options\": [\"Yes\", \"No\", \"Maybe\", \"Later\"],"
+        " \"correct_answer\": \"Yes\", \"explanation\": \"The questions are fixed.\"}",
+    };
+
+    QStringList chunks;
+    chunks << "[";
+    for (int i = 0; i < 3; ++i) {
+        chunks << QString::fromUtf8(questions[i]) + (i < 2 ? "," : "]");
+    }
+
+    QByteArray stream;
+    for (const QString &chunk : chunks) {
+        QJsonObject delta;
+        delta["content"] = chunk;
+        QJsonObject choice;
+        choice["delta"] = delta;
+        QJsonObject event;
+        event["choices"] = QJsonArray() << choice;
+        stream += "data: " + QJsonDocument(event).toJson(QJsonDocument::Compact) + "\n\n";
+    }
+    return stream + "data: [DONE]\n\n";
+}
+
+// Stand-in for a local model server: answers each complete POST with the
+// canned quiz after the configured latency
+static void serveCannedQuizzes(QTcpServer *server, int latency)
+{
+    QObject::connect(server, &QTcpServer::newConnection, server, [server, latency]() {
+        while (QTcpSocket *socket = server->nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+            std::shared_ptr<QByteArray> request = std::make_shared<QByteArray>();
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, request, latency]() {
+                request->append(socket->readAll());
+                int headerEnd = request->indexOf("\r\n\r\n");
+                if (headerEnd < 0) {
+                    return;
+                }
+                QRegExp length("Content-Length:\\s*(\\d+)", Qt::CaseInsensitive);
+                int bodySize = length.indexIn(QString::fromLatin1(request->left(headerEnd))) >= 0 ? length.cap(1).toInt() : 0;
+                if (request->size() < headerEnd + 4 + bodySize) {
+                    return;
+                }
+
+                request->clear();
+                QTimer::singleShot(latency, socket, [socket]() {
+                    socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n");
+                    socket->write(cannedEventStream());
+                    socket->disconnectFromHost();
+                });
+            });
+        }
+    });
+}
+
+static bool answerAndReview(QWidget *dialog)
+{
+    QLabel *question = dialog->findChild<QLabel*>("questionLabel");
+
+    bool ok = measure("answer", [&]() {
+        while (!findButton(dialog, "Review")) {
+            QPushButton *submit = findButton(dialog, "Submit");
+            if (!submit && !waitFor([&]() { return findButton(dialog, "Submit") || findButton(dialog, "Review"); })) {
+                return false;
+            }
+            if (!submit) {
+                continue;
+            }
+            for (QRadioButton *radio : dialog->findChildren<QRadioButton*>()) {
+                if (radio->isVisible()) {
+                    radio->click();
+                    break;
+                }
+            }
+            submit->click();
+        }
+        return true;
+    });
+
+    return ok && measure("review", [&]() {
+        findButton(dialog, "Review")->click();
+        // Step through with Next; the last question turns it into Close
+        for (int i = 0; i < 100 && dialog->isVisible(); ++i) {
+            QPushButton *next = findButton(dialog, "Next");
+            QPushButton *button = next ? next : findButton(dialog, "Close");
+            if (!button) {
+                return false;
+            }
+            button->click();
+            QCoreApplication::processEvents();
+        }
+        return !dialog->isVisible() && !question->text().isEmpty();
+    });
+}
+
+static bool runIteration(NPGuiInterface *plugin, bool fresh)
+{
+    QWidget *dialog = nullptr;
+    QListView *list = nullptr;
+
+    bool ok = measure("selection", [&]() {
+        plugin->showUi();
+        dialog = findDialog();
+        list = dialog ? dialog->findChild<QListView*>() : nullptr;
+        return list && waitFor([&]() { return list->model() && list->model()->rowCount() > 0; });
+    });
+
+    ok = ok && measure("import", [&]() {
+        QLabel *status = dialog->findChild<QLabel*>("statusLabel");
+        findButton(dialog, "Import")->click();
+        return waitFor([&]() { return status->text().contains("updated") || status->text().startsWith("Error"); })
+            && status->text().contains("updated");
+    });
+
+    // Fresh runs move on to the next book, cached runs reopen the last one
+    static int row = -1;
+    if (fresh) {
+        ++row;
+    }
+    list->setCurrentIndex(list->model()->index(qMax(0, row) % list->model()->rowCount(), 0));
+
+    ok = ok && measure(fresh ? "generate" : "cached", [&]() {
+        findButton(dialog, fresh ? "Fresh" : "Select")->click();
+        return waitFor([&]() { return onPage(dialog, "questionLabel") && findButton(dialog, "Submit"); });
+    });
+
+    return ok && answerAndReview(dialog);
+}
+
+static qint64 median(QVector<qint64> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.isEmpty() ? 0 : values.at(values.size() / 2);
+}
+
+static void report()
+{
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6\n")
+        .arg("flow", -10).arg("runs", 5).arg("min ms", 8).arg("med ms", 8).arg("med new", 10).arg("widgets", 8);
+    for (const QString &flow : g_order) {
+        QVector<qint64> msecs, allocations;
+        int widgets = 0;
+        for (const Sample &sample : g_samples[flow]) {
+            msecs.append(sample.msecs);
+            allocations.append(sample.allocations);
+            widgets = qMax(widgets, sample.widgets);
+        }
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+            .arg(flow, -10)
+            .arg(msecs.size(), 5)
+            .arg(*std::min_element(msecs.begin(), msecs.end()), 8)
+            .arg(median(msecs), 8)
+            .arg(median(allocations), 10)
+            .arg(widgets, 8);
+    }
+}
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "usage: quizbench --plugin FILE --scripts DIR [--iterations N] [--latency MS] [--books N] [--trace]\n"
+        "                 [--backend script|local]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    QString pluginPath, scriptsDir;
+    int iterations = 5;
+    int latency = 0;
+    int books = 500;
+    bool trace = false;
+    QString backend = "script";
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if (arg == "--plugin" && hasValue) {
+            pluginPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--scripts" && hasValue) {
+            scriptsDir = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            iterations = qMax(1, atoi(argv[++i]));
+        } else if (arg == "--latency" && hasValue) {
+            latency = qMax(0, atoi(argv[++i]));
+        } else if (arg == "--books" && hasValue) {
+            books = qMax(1, atoi(argv[++i]));
+        } else if (arg == "--backend" && hasValue) {
+            backend = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--trace") {
+            trace = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (pluginPath.isEmpty() || scriptsDir.isEmpty() || (backend != "script" && backend != "local")) {
+        usage();
+        return 2;
+    }
+
+    // The plugin resolves its paths when it is loaded, so the onboard root
+    // has to be in place before that
+    QTemporaryDir root;
+    if (!root.isValid()) {
+        std::fprintf(stderr, "quizbench: unable to create a temporary directory\n");
+        return 1;
+    }
+    qputenv("QUIZ_ONBOARD_ROOT", QFile::encodeName(root.path()));
+    qputenv("QUIZ_BENCH_LATENCY_MS", QByteArray::number(latency));
+    qputenv("QUIZ_BENCH_BOOKS", QByteArray::number(books));
+
+    QString quizDir = root.path() + "/.adds/quiz";
+    QByteArray env = "QUIZ_BACKEND=script\nQUIZ_BOOKS_SOURCE=server\nQUIZ_PREFETCH=0\n";
+    if (trace) {
+        env += "QUIZ_REPAINT_TRACE=1\n";
+    }
+    QByteArray bookList = "{\"books\": [\"Benchmark Book 00001\", \"Benchmark Book 00002\"]}\n";
+    if (!writeFile(root.path() + "/.adds/pkm/.env", env)
+            || !writeFile(quizDir + "/books.json", bookList)
+            || !writeFile(quizDir + "/prompts.txt", "===SYSTEM_PROMPT===\nBenchmark\n===USER_PROMPT===\n{book_title}\n")
+            || !installScript(scriptsDir + "/generateQuiz.sh", quizDir + "/generateQuiz.sh")
+            || !installScript(scriptsDir + "/updateBooks.sh", quizDir + "/updateBooks.sh")) {
+        std::fprintf(stderr, "quizbench: unable to set up %s\n", qPrintable(root.path()));
+        return 1;
+    }
+
+    QApplication app(argc, argv);
+
+    // .env is read on every quiz, so the server's port can be added now
+    QTcpServer server;
+    if (backend == "local") {
+        if (!server.listen(QHostAddress::LocalHost)) {
+            std::fprintf(stderr, "quizbench: %s\n", qPrintable(server.errorString()));
+            return 1;
+        }
+        serveCannedQuizzes(&server, latency);
+        env.replace("QUIZ_BACKEND=script", "QUIZ_BACKEND=local");
+        env += QString("QUIZ_LOCAL_URL=http://127.0.0.1:%1/v1/chat/completions\n").arg(server.serverPort()).toUtf8();
+        writeFile(root.path() + "/.adds/pkm/.env", env);
+    }
+
+    QPluginLoader loader(pluginPath);
+    NPGuiInterface *plugin = qobject_cast<NPGuiInterface*>(loader.instance());
+    if (!plugin) {
+        std::fprintf(stderr, "quizbench: %s\n", qPrintable(loader.errorString()));
+        return 1;
+    }
+
+    // Alternate fresh generation with cache hits on the same books
+    for (int i = 0; i < iterations; ++i) {
+        if (!runIteration(plugin, i % 2 == 0)) {
+            return 1;
+        }
+    }
+
+    report();
+    return 0;
+}
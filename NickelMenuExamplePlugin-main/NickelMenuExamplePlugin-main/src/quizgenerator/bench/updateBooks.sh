@@ -0,0 +1,12 @@
+#!/bin/sh
+# Stand-in for updateBooks.sh used by quizbench. Waits QUIZ_BENCH_LATENCY_MS
+# and writes QUIZ_BENCH_BOOKS (default 500) generated titles to books.json.
+sleep "$(awk "BEGIN { print ${QUIZ_BENCH_LATENCY_MS:-0} / 1000 }")"
+
+awk -v count="${QUIZ_BENCH_BOOKS:-500}" 'BEGIN {
+    printf "{\"books\": ["
+    for (i = 1; i <= count; i++) {
+        printf "%s{\"title\": \"Benchmark Book %05d\", \"author\": \"Author %d\"}", (i > 1 ? "," : ""), i, i % 37
+    }
+    print "]}"
+}' > "$QUIZ_ONBOARD_ROOT/.adds/quiz/books.json"
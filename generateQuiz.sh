@@ -42,12 +42,20 @@ fi
 URL="$OPENAI_API_URL"
 API_KEY="$OPENAI_API_KEY"
 
-# Read prompts and escape them for JSON
-SYSTEM_PROMPT=$(sed -n '/===SYSTEM_PROMPT===/,/===USER_PROMPT===/p' "$PROMPTS_FILE" | grep -v "===.*PROMPT===" | sed 's/"/\\"/g' | tr '\n' ' ')
-USER_PROMPT=$(sed -n '/===USER_PROMPT===/,$p' "$PROMPTS_FILE" | grep -v "===.*PROMPT===" | sed 's/"/\\"/g' | tr '\n' ' ')
+# The plugin passes the prompts already rendered from prompts.txt; when the
+# script is run by hand, fill in the title and question count here. jq
+# escapes both for JSON.
+if [ -n "$QUIZ_USER_PROMPT" ]; then
+  SYSTEM_PROMPT="$QUIZ_SYSTEM_PROMPT"
+  USER_PROMPT="$QUIZ_USER_PROMPT"
+else
+  SYSTEM_PROMPT=$(sed -n '/===SYSTEM_PROMPT===/,/===USER_PROMPT===/p' "$PROMPTS_FILE" | grep -v "===.*PROMPT===")
+  USER_PROMPT=$(sed -n '/===USER_PROMPT===/,$p' "$PROMPTS_FILE" | grep -v "===.*PROMPT===")
 
-# Replace book title placeholder
-USER_PROMPT=$(echo "$USER_PROMPT" | sed "s/{book_title}/$BOOK_TITLE/g")
+  # Escape / and & so titles containing them are substituted literally
+  TITLE_ESCAPED=$(printf '%s' "$BOOK_TITLE" | sed 's/[\/&]/\\&/g')
+  USER_PROMPT=$(printf '%s' "$USER_PROMPT" | sed "s/{book_title}/$TITLE_ESCAPED/g; s/{count}/${QUIZ_COUNT:-3}/g")
+fi
 
 # Create JSON request
 REQUEST=$($JQ_BIN -n \
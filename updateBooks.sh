@@ -24,15 +24,53 @@ fi
 # Create output directory if it doesn't exist
 mkdir -p "$OUTPUT_DIR"
 
+ETAG_FILE="$OUTPUT_DIR/books.etag"
+HEADERS_FILE="$OUTPUT_DIR/books.headers"
+
+# mtime and size of books.json, which the stored ETag belongs to
+list_stamp() {
+    stat -c '%Y:%s' "$OUTPUT_FILE" 2>/dev/null
+}
+
+# Send the ETag of the list we already have, so an unchanged list is not
+# downloaded again. The ETag file holds the list's stamp, then the ETag;
+# it is ignored once books.json has been changed by anything else.
+etag=""
+if [ -f "$ETAG_FILE" ] && [ -f "$OUTPUT_FILE" ] && [ "$(sed -n 1p "$ETAG_FILE")" = "$(list_stamp)" ]; then
+    etag=$(sed -n 2p "$ETAG_FILE")
+fi
+
 # Fetch book list
-response=$($CURL_BIN -s "$SERVER_URL/books")
+if [ -n "$etag" ]; then
+    response=$($CURL_BIN -s -D "$HEADERS_FILE" -H "If-None-Match: $etag" -w '\n%{http_code}' "$SERVER_URL/books")
+else
+    response=$($CURL_BIN -s -D "$HEADERS_FILE" -w '\n%{http_code}' "$SERVER_URL/books")
+fi
+status=$(echo "$response" | tail -n 1)
+response=$(echo "$response" | sed '$d')
+new_etag=$(grep -i '^etag:' "$HEADERS_FILE" 2>/dev/null | tail -n 1 | cut -d' ' -f2- | tr -d '\r')
+rm -f "$HEADERS_FILE"
+
+if [ "$status" = "304" ]; then
+    echo "Books list is up to date"
+    exit 0
+fi
 
-# Check if response is valid JSON
-if echo "$response" | $JQ_BIN . >/dev/null 2>&1; then
-    # Save response to file
-    echo "$response" > "$OUTPUT_FILE"
-    echo "Successfully updated books list"
+# Check if response is a valid book list
+if [ "$status" = "200" ] && echo "$response" | $JQ_BIN -e 'has("books")' >/dev/null 2>&1; then
+    # Only replace the file when the list changed
+    if [ -f "$OUTPUT_FILE" ] && [ "$response" = "$(cat "$OUTPUT_FILE")" ]; then
+        echo "Books list is up to date"
+    else
+        echo "$response" > "$OUTPUT_FILE.tmp" && mv "$OUTPUT_FILE.tmp" "$OUTPUT_FILE"
+        echo "Successfully updated books list"
+    fi
+    if [ -n "$new_etag" ]; then
+        printf '%s\n%s\n' "$(list_stamp)" "$new_etag" > "$ETAG_FILE"
+    else
+        rm -f "$ETAG_FILE"
+    fi
 else
     echo "Error: Invalid response from server" >&2
     exit 1
-fi 
\ No newline at end of file
+fi